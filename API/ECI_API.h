@@ -35,7 +35,6 @@
 
 #include <DSP2833x_Device.h>     	// DSP2833x Headerfile Include File
 #include <DSP2833x_Examples.h>  	// DSP2833x Examples Include File
-#include <lut_def.h>				// Sin Lookup table
 
 /********************************************************************************************/
 //MODULATION, SPI, and DEBUG FLAGS.  MAKE SURE SETTINGS ARE CORRECT.
@@ -44,6 +43,24 @@
 									//	on the Rxx & Ixx connections.
 #define DEBUG_MODE 1				//Flag to compile and run in debug mode.
 									//(DEBUG_MODE = 1 is enabled), controls debug flags. 
+#define FLOAT32_MATH 1				//Flag for float32-only control math (FLOAT32_MATH = 1) vs. double libm
+									//	calls (FLOAT32_MATH = 0).  Checked on the host with 'make -C host float32-check'.
+#define TRIG_LUT 1					//Flag for control sin/cos interpolated from the generated quarter-wave table in
+									//	ECI_SinLUT.h (TRIG_LUT = 1) vs. sinf/cosf of the phase in radians (TRIG_LUT = 0).
+#define ADC_SOCA_TRIGGER 1			//Flag for ADC SEQ1 started by EPwm1 SOCA with timer_isr() run on the SEQ1
+									//	end-of-conversion interrupt (ADC_SOCA_TRIGGER = 1) vs. SEQ1 started in
+									//	software from timer_isr() on the EPwm1 interrupt (ADC_SOCA_TRIGGER = 0).
+#define ADC_DMA 1					//Flag for DMA ping-pong capture with timer_isr() run on the DMA CH1 interrupt
+									//	(ADC_DMA = 1, needs ADC_SOCA_TRIGGER) vs. reading ADCRESULTx directly (ADC_DMA = 0).
+#define ADC_OVERSAMPLE 4			//ADC sequences averaged per PWM period when ADC_DMA = 1 (1, 2, 4 or 8).
+#define ADC_SIMULTANEOUS 1			//Flag for simultaneous sampling of the A_n/B_n pairs (ADC_SIMULTANEOUS = 1) vs.
+									//	cascaded sequential sampling of all 16 channels (ADC_SIMULTANEOUS = 0).
+#define PROFILE 1					//Flag for the ISR stage profiler on CPU Timer 1 (PROFILE = 1) vs. compiled
+									//	out (PROFILE = 0).  See ECI_Profile.h.
+#define CAPTURE 1					//Flag for the golden-vector capture of the ISR inputs and compares after
+									//	each reset (CAPTURE = 1) vs. compiled out (CAPTURE = 0).  See ECI_Capture.h.
+#define CAN_RX_NESTED 1				//Flag for letting the eCAN receive interrupt preempt timer_isr() (CAN_RX_NESTED = 1)
+									//	vs. waiting for it to finish (CAN_RX_NESTED = 0).  See ECI_CanRx.h.
 /********************************************************************************************/
 
 //Constant Definitions:
@@ -57,6 +74,24 @@
 
 	#define GPBMUX_1 0x00000005  			//Defines register value for GPBMUX1.
 
+#if(ADC_SOCA_TRIGGER && !MODULATION)
+	#error "ADC_SOCA_TRIGGER needs the ePWM modules (MODULATION = 1)."
+#endif
+
+//ADC result index of channel An/Bn.  In simultaneous mode slot k holds An in ADCRESULT(2k)
+//	and Bn in ADCRESULT(2k+1).
+#if(ADC_SIMULTANEOUS)
+	#define AIN_A(n) (2*ADC_SLOT_##n)
+	#define AIN_B(n) (2*ADC_SLOT_##n + 1)
+#else
+	#define AIN_A(n) (n)
+	#define AIN_B(n) (8 + n)
+#endif
+
+#if(ADC_DMA && !ADC_SOCA_TRIGGER)
+	#error "ADC_DMA needs ADC_SOCA_TRIGGER = 1."
+#endif
+
 #if(SPI)
 	#define GPBMUX_2 0x00055000			//Defines register value for GPBMUX2 when using SPI.
 #else
@@ -64,7 +99,16 @@
 #endif
 
 #define PWM_PD 3750		 		//Defines count variable for switching at 10,080. /9.6 kHz/ w/ 150 MHZ SYSCLK.
+#define ADC_SOCA_EVENT ET_CTR_ZERO	//EPwm1 event that starts the ADC when ADC_SOCA_TRIGGER = 1 (ET_CTR_ZERO or ET_CTR_PRD).
 #define TIMER_0_PD 15000			//Defines timer 0 period. (14881 = ~10,080 Hz).
+#define ADC_SLOT_0 0				//Simultaneous sampling: conversion slot of pair A0/B0 (via, va).
+#define ADC_SLOT_2 1				//	A2/B2 (ioa, ia), next to A0/B0 so each phase's V and I are adjacent.
+#define ADC_SLOT_1 2				//	A1/B1 (vib, vb).
+#define ADC_SLOT_3 3				//	A3/B3 (iob, ib).
+#define ADC_SLOT_6 4				//	A6/B6 (vic, vc).
+#define ADC_SLOT_4 5				//	A4/B4 (ioc, ic).
+#define ADC_SLOT_5 6				//	A5/B5 (vibref, Vdc).
+#define ADC_SLOT_7 7				//	A7/B7 (vicref, viaref).
 #define DEAD_BAND 150				//Defines Dead-band for rising and falling edge (150*1/150Mhz = 1us)
 #define DAC_ADDRESS 0x0C			//I2C address of the DAC.
 #define DAC1 0x01					//For use with DAC, this is the internal address of DAC1.
@@ -72,9 +116,42 @@
 #define DAC3 0x04					//DAC3.
 #define DAC4 0x08					//DAC4.
 
+//Carrier position (CarrierPos(), 0 to 2*PWM_PD) of the event that raises the control interrupt.
+#if(ADC_DMA)
+	#define CTRL_TRIGGER_POS ((ADC_OVERSAMPLE - 1)*(2*PWM_PD/ADC_OVERSAMPLE))	//Last SOC, the SOCs are 2*PWM_PD/OS apart from zero.
+#elif(ADC_SOCA_TRIGGER && ADC_SOCA_EVENT == ET_CTR_PRD)
+	#define CTRL_TRIGGER_POS PWM_PD
+#else
+	#define CTRL_TRIGGER_POS 0
+#endif
+
+//Compare shadow load on the first carrier zero or period at least a half period after the trigger,
+//	CTR_PRD when the trigger is in the down-count half (ADC_OVERSAMPLE >= 4 with ADC_DMA).  CMP_DEADLINE
+//	is the TBCLK counts from the trigger to that load, the ISR has to write the compares within it or
+//	they go out a period late:
+//
+//		trigger at 0 or PWM_PD				2*PWM_PD (one period)
+//		ADC_DMA, ADC_OVERSAMPLE = 4			3*PWM_PD/2 (3/4 period, load at period)
+//		ADC_DMA, ADC_OVERSAMPLE = 8			5*PWM_PD/4 (5/8 period, load at period)
+#if(CTRL_TRIGGER_POS < PWM_PD)
+	#define CMP_LOAD_MODE CC_CTR_ZERO
+	#define CMP_LOAD_POS 0
+#else
+	#define CMP_LOAD_MODE CC_CTR_PRD
+	#define CMP_LOAD_POS PWM_PD
+#endif
+#define CMP_DEADLINE (2*PWM_PD - (CTRL_TRIGGER_POS - CMP_LOAD_POS))
+
 //Prototype for timer_isr function, this is needed for initialization.
 interrupt void timer_isr();
 
+#if(ADC_DMA)
+#include <ECI_AdcDma.h>				// DMA ping-pong ADC capture
+#endif
+#include <ECI_I2cDac.h>				// Interrupt driven DAC writes
+#include <ECI_CanRx.h>				// Interrupt driven eCAN receive with per mailbox handlers
+#include <ECI_Param.h>				// Runtime parameter dictionary over CAN
+
 /***********************************************************/
 //API Function Definitions
 /***********************************************************/
@@ -275,7 +352,7 @@ inline void DisablePWM_R(){GpioDataRegs.GPBSET.bit.GPIO34 = 1;	}  	//Disables PW
 inline void DisablePWM_I(){GpioDataRegs.GPBSET.bit.GPIO35 = 1;	}  	//Disables PWM B, Active Low.
 
 //Note: can't have PWM functions if PWM module isn't used.
-#if defined(RK1B2B) || defined (RK2B2B) && !defined(RK1NPC) && !defined(RK2NPC)
+//Back to back racks.  Both sets are built, the rack profile picks one at boot (see main.c).
 	/*PWM Set Duty Cycle Functions*/
 	void SetPWM_Rau(Uint16 D)	{EPwm1Regs.CMPA.half.CMPA = (Uint16)(D);	}	//PWM1A
 	void SetPWM_Rad(Uint16 D)	{EPwm1Regs.CMPB = (Uint16)(D);				}	//PWM1B
@@ -289,7 +366,20 @@ inline void DisablePWM_I(){GpioDataRegs.GPBSET.bit.GPIO35 = 1;	}  	//Disables PW
 	void SetPWM_Ibd(Uint16 D)	{EPwm5Regs.CMPB = (Uint16)(D);				}	//PWM5B
 	void SetPWM_Icu(Uint16 D)	{EPwm6Regs.CMPA.half.CMPA = (Uint16)(D);	}	//PWM6A
 	void SetPWM_Icd(Uint16 D)	{EPwm6Regs.CMPB = (Uint16)(D);				}	//PWM6B
-#endif
+
+	//Rectifier and inverter compare values written back to back (cmp[] = a, b, c, see ECI_Modulation.h).
+	inline void SetPWM_R(const Uint16 *cmp)
+	{
+		EPwm1Regs.CMPA.half.CMPA = cmp[0];
+		EPwm2Regs.CMPA.half.CMPA = cmp[1];
+		EPwm3Regs.CMPA.half.CMPA = cmp[2];
+	}
+	inline void SetPWM_I(const Uint16 *cmp)
+	{
+		EPwm4Regs.CMPA.half.CMPA = cmp[0];
+		EPwm5Regs.CMPA.half.CMPA = cmp[1];
+		EPwm6Regs.CMPA.half.CMPA = cmp[2];
+	}
 
 #if(MODULATION)
 #else
@@ -369,7 +459,7 @@ inline void DisablePWM_I(){GpioDataRegs.GPBSET.bit.GPIO35 = 1;	}  	//Disables PW
 
 #endif		//End alternative IGBT control.
 
-#if defined(RK1NPC) || defined(RK2NPC) && !defined(RK1B2B) && !defined(RK2B2B)
+//NPC racks, same EPwm1-6 registers as the B2B functions above.  The rack profile picks one set.
 	/*PWM Set Duty Cycle Functions*/
 	void SetPWM_Na1(Uint16 D)	{EPwm1Regs.CMPA.half.CMPA = (Uint16)(D);	}	//PWM1A
 	void SetPWM_Na3(Uint16 D)	{EPwm1Regs.CMPB = (Uint16)(D);				}	//PWM1B
@@ -383,10 +473,26 @@ inline void DisablePWM_I(){GpioDataRegs.GPBSET.bit.GPIO35 = 1;	}  	//Disables PW
 	void SetPWM_Nc3(Uint16 D)	{EPwm5Regs.CMPB = (Uint16)(D);				}	//PWM5B
 	void SetPWM_Nc2(Uint16 D)	{EPwm6Regs.CMPA.half.CMPA = (Uint16)(D);	}	//PWM6A
 	void SetPWM_Nc4(Uint16 D)	{EPwm6Regs.CMPB = (Uint16)(D);				}	//PWM6B
-#endif
+
+	//All six NPC compare values written back to back (cmp[] = Na1, Na2, Nb1, Nb2, Nc1, Nc2).
+	inline void SetPWM_N(const Uint16 *cmp)
+	{
+		EPwm1Regs.CMPA.half.CMPA = cmp[0];
+		EPwm2Regs.CMPA.half.CMPA = cmp[1];
+		EPwm3Regs.CMPA.half.CMPA = cmp[2];
+		EPwm4Regs.CMPA.half.CMPA = cmp[3];
+		EPwm5Regs.CMPA.half.CMPA = cmp[4];
+		EPwm6Regs.CMPA.half.CMPA = cmp[5];
+	}
 /*****************************************************************************************************/
 /*ADC GET FUNCTIONS*/
 
+#if(ADC_SOCA_TRIGGER)
+//Start ADC Sequence.  With ADC_SOCA_TRIGGER the sequence is started by EPwm1 SOCA
+//	and timer_isr() only runs once it has finished, so there is nothing left to do.
+//	With ADC_DMA the period averages are taken in ClearControlISR().
+inline void StartADC()	{}
+#else
 //Start ADC Sequence. This starts an ADC sequence.
 //	Note: There is a 2 us delay inserted here to let the ADC sequence finish.  This is
 //			to ensure that the adc values that are read are up to date. This can
@@ -396,49 +502,83 @@ inline void StartADC()
 	AdcRegs.ADCTRL2.bit.SOC_SEQ1 = 1;  		//Start adc conversion.
 	DELAY_US(2);							//2us delay for conversion to finsih.  	
 }
+#endif
+#if(ADC_DMA)
+/*Individual ADC Reads.  Period averages from the DMA buffer, already right aligned.*/
+inline float32 GetAIN_A0()	{return AdcAin[AIN_A(0)];}	//Read ADC Channel A0
+inline float32 GetAIN_A1()	{return AdcAin[AIN_A(1)];}	//Read ADC Channel A1
+inline float32 GetAIN_A2()	{return AdcAin[AIN_A(2)];}	//Read ADC Channel A2
+inline float32 GetAIN_A3()	{return AdcAin[AIN_A(3)];}	//Read ADC Channel A3
+inline float32 GetAIN_A4()	{return AdcAin[AIN_A(4)];}	//Read ADC Channel A4
+inline float32 GetAIN_A5()	{return AdcAin[AIN_A(5)];}	//Read ADC Channel A5
+inline float32 GetAIN_A6()	{return AdcAin[AIN_A(6)];}	//Read ADC Channel A6
+inline float32 GetAIN_A7()	{return AdcAin[AIN_A(7)];}	//Read ADC Channel A7
+inline float32 GetAIN_B0()	{return AdcAin[AIN_B(0)];}	//Read ADC Channel B0
+inline float32 GetAIN_B1()	{return AdcAin[AIN_B(1)];}	//Read ADC Channel B1
+inline float32 GetAIN_B2()	{return AdcAin[AIN_B(2)];}	//Read ADC Channel B2
+inline float32 GetAIN_B3()	{return AdcAin[AIN_B(3)];}	//Read ADC Channel B3
+inline float32 GetAIN_B4()	{return AdcAin[AIN_B(4)];}	//Read ADC Channel B4
+inline float32 GetAIN_B5()	{return AdcAin[AIN_B(5)];}	//Read ADC Channel B5
+inline float32 GetAIN_B6()	{return AdcAin[AIN_B(6)];}	//Read ADC Channel B6
+inline float32 GetAIN_B7()	{return AdcAin[AIN_B(7)];}	//Read ADC Channel B7
+
+inline void ReadAIN()		{}							//AdcAin[] is filled by ClearControlISR().
+#else
+/*Individual ADC Reads.  Must Right Align and Scale.*/
+#define ADC_RESULT(i) ((&AdcRegs.ADCRESULT0)[i])		//ADCRESULT0-15 are contiguous.
+inline float32 GetAIN_A0()	{return ((ADC_RESULT(AIN_A(0)) >> 4));}	//Read ADC Channel A0
+inline float32 GetAIN_A1()	{return ((ADC_RESULT(AIN_A(1)) >> 4));}	//Read ADC Channel A1
+inline float32 GetAIN_A2()	{return ((ADC_RESULT(AIN_A(2)) >> 4));}	//Read ADC Channel A2
+inline float32 GetAIN_A3()	{return ((ADC_RESULT(AIN_A(3)) >> 4));}	//Read ADC Channel A3
+inline float32 GetAIN_A4()	{return ((ADC_RESULT(AIN_A(4)) >> 4));}	//Read ADC Channel A4
+inline float32 GetAIN_A5()	{return ((ADC_RESULT(AIN_A(5)) >> 4));}	//Read ADC Channel A5
+inline float32 GetAIN_A6()	{return ((ADC_RESULT(AIN_A(6)) >> 4));}	//Read ADC Channel A6
+inline float32 GetAIN_A7()	{return ((ADC_RESULT(AIN_A(7)) >> 4));}	//Read ADC Channel A7
+inline float32 GetAIN_B0()	{return ((ADC_RESULT(AIN_B(0)) >> 4));}	//Read ADC Channel B0
+inline float32 GetAIN_B1()	{return ((ADC_RESULT(AIN_B(1)) >> 4));}	//Read ADC Channel B1
+inline float32 GetAIN_B2()	{return ((ADC_RESULT(AIN_B(2)) >> 4));}	//Read ADC Channel B2
+inline float32 GetAIN_B3()	{return ((ADC_RESULT(AIN_B(3)) >> 4));}	//Read ADC Channel B3
+inline float32 GetAIN_B4()	{return ((ADC_RESULT(AIN_B(4)) >> 4));}	//Read ADC Channel B4
+inline float32 GetAIN_B5()	{return ((ADC_RESULT(AIN_B(5)) >> 4));}	//Read ADC Channel B5
+inline float32 GetAIN_B6()	{return ((ADC_RESULT(AIN_B(6)) >> 4));}	//Read ADC Channel B6
+inline float32 GetAIN_B7()	{return ((ADC_RESULT(AIN_B(7)) >> 4));}	//Read ADC Channel B7
+
+float32 AdcAin[16];									//Right aligned results, indexed by result, see AIN_A()/AIN_B().
+
+//ReadAIN(): Copies the results into AdcAin[], as ClearControlISR() does with ADC_DMA.  Call after StartADC().
+inline void ReadAIN()
+{
+	Uint16 k;
+
+	for(k = 0; k < 16; k++) AdcAin[k] = ADC_RESULT(k) >> 4;
+}
+#endif
+
 //GetAIN_Vec(): Pass in a 16-element array by reference, this function fills in with AIN0-16.
 //MUST BE float32 OR THIS WILL CAUSE PROBLEMS.
 void GetAIN_Vec(float32 ADC_VEC[])
 {
 	if(ADC_VEC != 0) //Make sure it's initialized.
 	{
-		ADC_VEC[0] = (AdcRegs.ADCRESULT0 >> 4);		//Right Align, scale properly. AINA0
-		ADC_VEC[1] = (AdcRegs.ADCRESULT1 >> 4);		//AINA1
-		ADC_VEC[2] = (AdcRegs.ADCRESULT2 >> 4);		//AINA2
-		ADC_VEC[3] = (AdcRegs.ADCRESULT3 >> 4);		//AINA3
-		ADC_VEC[4] = (AdcRegs.ADCRESULT4 >> 4);		//AINA4
-		ADC_VEC[5] = (AdcRegs.ADCRESULT5 >> 4);		//AINA5
-		ADC_VEC[6] = (AdcRegs.ADCRESULT6 >> 4);		//AINA6
-		ADC_VEC[7] = (AdcRegs.ADCRESULT7 >> 4);		//AINA7
-		ADC_VEC[8] = (AdcRegs.ADCRESULT8 >> 4);		//AINB0
-		ADC_VEC[9] = (AdcRegs.ADCRESULT9 >> 4);  	//AINB1
-		ADC_VEC[10] = (AdcRegs.ADCRESULT10 >> 4);		//AINB2
-		ADC_VEC[11] = (AdcRegs.ADCRESULT11 >> 4);		//AINB3
-		ADC_VEC[12] = (AdcRegs.ADCRESULT12 >> 4);		//AINB4
-		ADC_VEC[13] = (AdcRegs.ADCRESULT13 >> 4);		//AINB5
-		ADC_VEC[14] = (AdcRegs.ADCRESULT14 >> 4);		//AINB6
-		ADC_VEC[15] = (AdcRegs.ADCRESULT15 >> 4);		//AINB7
+		ADC_VEC[0] = GetAIN_A0();		//AINA0
+		ADC_VEC[1] = GetAIN_A1();		//AINA1
+		ADC_VEC[2] = GetAIN_A2();		//AINA2
+		ADC_VEC[3] = GetAIN_A3();		//AINA3
+		ADC_VEC[4] = GetAIN_A4();		//AINA4
+		ADC_VEC[5] = GetAIN_A5();		//AINA5
+		ADC_VEC[6] = GetAIN_A6();		//AINA6
+		ADC_VEC[7] = GetAIN_A7();		//AINA7
+		ADC_VEC[8] = GetAIN_B0();		//AINB0
+		ADC_VEC[9] = GetAIN_B1();		//AINB1
+		ADC_VEC[10] = GetAIN_B2();		//AINB2
+		ADC_VEC[11] = GetAIN_B3();		//AINB3
+		ADC_VEC[12] = GetAIN_B4();		//AINB4
+		ADC_VEC[13] = GetAIN_B5();		//AINB5
+		ADC_VEC[14] = GetAIN_B6();		//AINB6
+		ADC_VEC[15] = GetAIN_B7();		//AINB7
 	}	
 }
 
-/*Individual ADC Reads.  Must Right Align and Scale.*/
-inline float32 GetAIN_A0()	{return ((AdcRegs.ADCRESULT0 >> 4));}	//Read ADC Channel A0
-inline float32 GetAIN_A1()	{return ((AdcRegs.ADCRESULT1 >> 4));}	//Read ADC Channel A1
-inline float32 GetAIN_A2()	{return ((AdcRegs.ADCRESULT2 >> 4));}	//Read ADC Channel A2
-inline float32 GetAIN_A3()	{return ((AdcRegs.ADCRESULT3 >> 4));}	//Read ADC Channel A3
-inline float32 GetAIN_A4()	{return ((AdcRegs.ADCRESULT4 >> 4));}	//Read ADC Channel A4
-inline float32 GetAIN_A5()	{return ((AdcRegs.ADCRESULT5 >> 4));}	//Read ADC Channel A5
-inline float32 GetAIN_A6()	{return ((AdcRegs.ADCRESULT6 >> 4));}	//Read ADC Channel A6
-inline float32 GetAIN_A7()	{return ((AdcRegs.ADCRESULT7 >> 4));}	//Read ADC Channel A7
-inline float32 GetAIN_B0()	{return ((AdcRegs.ADCRESULT8 >> 4));}	//Read ADC Channel B0
-inline float32 GetAIN_B1()	{return ((AdcRegs.ADCRESULT9 >> 4));}	//Read ADC Channel B1
-inline float32 GetAIN_B2()	{return ((AdcRegs.ADCRESULT10 >> 4));}	//Read ADC Channel B2
-inline float32 GetAIN_B3()	{return ((AdcRegs.ADCRESULT11 >> 4));}	//Read ADC Channel B3
-inline float32 GetAIN_B4()	{return ((AdcRegs.ADCRESULT12 >> 4));}	//Read ADC Channel B4
-inline float32 GetAIN_B5()	{return ((AdcRegs.ADCRESULT13 >> 4));}	//Read ADC Channel B5
-inline float32 GetAIN_B6()	{return ((AdcRegs.ADCRESULT14 >> 4));}	//Read ADC Channel B6
-inline float32 GetAIN_B7()	{return ((AdcRegs.ADCRESULT15 >> 4));}	//Read ADC Channel B7
-
 //ADC ISR: Since the Get_AINxx() returns the values, the ISR just resets the ADC for the next sequence.
 interrupt void adc_isr(void)
 {
@@ -450,6 +590,50 @@ interrupt void adc_isr(void)
 	return;
 }
 
+//ClearControlISR(): Call first in timer_isr().  Clears the flag of whichever interrupt runs
+//	the control code (DMA CH1, SEQ1 end-of-conversion or EPwm1) so the next period can trigger it.
+//	With ADC_DMA it also swaps the ping-pong halves and averages the finished one.
+inline void ClearControlISR()
+{
+#if(ADC_DMA)
+	AdcDmaAverage(AdcDmaSwap());
+#elif(ADC_SOCA_TRIGGER)
+	AdcRegs.ADCTRL2.bit.RST_SEQ1 = 1;					//Reset Sequencer, results stay valid.
+	AdcRegs.ADCST.bit.INT_SEQ1_CLR = 1;					//Clear SEQ1 interrupt flag.
+#else
+	EPwm1Regs.ETCLR.bit.INT = 1;						//Clear EPwm1 interrupt flag.
+#endif
+}
+
+//AckControlISR(): Call last in timer_isr().  Acknowledges the PIE group of the control interrupt.
+inline void AckControlISR()
+{
+#if(ADC_DMA)
+	PieCtrlRegs.PIEACK.all = PIEACK_GROUP7;				//DINTCH1 is group 7.
+#elif(ADC_SOCA_TRIGGER)
+	PieCtrlRegs.PIEACK.all = PIEACK_GROUP1;				//ADCINT is group 1.
+#else
+	PieCtrlRegs.PIEACK.all = PIEACK_GROUP3;				//EPWM1_INT is group 3.
+#endif
+}
+
+//ControlISRPending(): 1 if the control interrupt has been raised again since it was taken,
+//	i.e. timer_isr() has run into the next period.
+inline Uint16 ControlISRPending()
+{
+#if(ADC_DMA)
+	return PieCtrlRegs.PIEIFR7.bit.INTx1;				//DINTCH1.
+#elif(ADC_SOCA_TRIGGER)
+	return PieCtrlRegs.PIEIFR1.bit.INTx6;				//ADCINT.
+#else
+	return PieCtrlRegs.PIEIFR3.bit.INTx1;				//EPWM1_INT.
+#endif
+}
+
+#include <ECI_Load.h>								// ISR overrun detection and load metering
+#include <ECI_Profile.h>							// ISR stage profiler (empty when PROFILE = 0), after ECI_Load.h for CarrierPos()
+#include <ECI_Capture.h>							// Golden-vector capture of the ISR I/O (empty when CAPTURE = 0)
+
 /********************************************************************************************************/
 //Timer start & stop functions.
 inline void StartTimer()	{CpuTimer0Regs.TCR.bit.TSS = 0;}	//Start CPU Timer.
@@ -597,9 +781,15 @@ void DSP_init()
 
 	//Then set all PWM(1-6) modules up.
 	//*********PWM 1*********//
+#if(ADC_SOCA_TRIGGER)
+	EPwm1Regs.ETSEL.bit.SOCASEL = ADC_SOCA_EVENT; // Start ADC SEQ1 on Zero (or Period) event
+	EPwm1Regs.ETSEL.bit.SOCAEN = 1;  			  // Enable SOCA
+	EPwm1Regs.ETPS.bit.SOCAPRD = ET_1ST;          // Generate SOCA on 1st event
+#else
 	EPwm1Regs.ETSEL.bit.INTSEL = ET_CTR_ZERO;     // Select INT on Zero event
 	EPwm1Regs.ETSEL.bit.INTEN = 1;  			  // Enable INT
 	EPwm1Regs.ETPS.bit.INTPRD = ET_1ST;           // Generate INT on 1st event
+#endif
 
 	EPwm1Regs.TBPRD = PWM_PD;						//Set Switching Frequency.
 	EPwm1Regs.TBCTL.bit.CTRMODE = TB_COUNT_UPDOWN;		//Counter will count up.
@@ -611,8 +801,8 @@ void DSP_init()
 	EPwm1Regs.CMPCTL.bit.SHDWAMODE = CC_SHADOW;		//Enable Shadow register for CMPA.
 	EPwm1Regs.CMPCTL.bit.SHDWBMODE = CC_SHADOW;		//Enable Shadow register for CMPB.
 	
-	EPwm1Regs.CMPCTL.bit.LOADAMODE = CC_CTR_ZERO;	//Loads CMPA on cnt = 0;
-	EPwm1Regs.CMPCTL.bit.LOADBMODE = CC_CTR_ZERO;	//Loads CMPB when cnt = 0
+	EPwm1Regs.CMPCTL.bit.LOADAMODE = CMP_LOAD_MODE;	//Loads CMPA on cnt = 0 or period, see CMP_DEADLINE.
+	EPwm1Regs.CMPCTL.bit.LOADBMODE = CMP_LOAD_MODE;	//Loads CMPB with CMPA.
 	
 	EPwm1Regs.DBCTL.bit.OUT_MODE = DB_FULL_ENABLE;	//Enables Dead-band.
 	EPwm1Regs.DBCTL.bit.POLSEL = DB_ACTV_HIC;		//Dead-band is active high complementary.
@@ -642,8 +832,8 @@ void DSP_init()
 	EPwm2Regs.CMPCTL.bit.SHDWAMODE = CC_SHADOW;		//Enable Shadow register for CMPA.
 	EPwm2Regs.CMPCTL.bit.SHDWBMODE = CC_SHADOW;		//Enable Shadow register for CMPB.
 
-	EPwm2Regs.CMPCTL.bit.LOADAMODE = CC_CTR_ZERO;	//Loads CMPA on cnt = 0;
-	EPwm2Regs.CMPCTL.bit.LOADBMODE = CC_CTR_ZERO;	//Loads CMPB when cnt = 0
+	EPwm2Regs.CMPCTL.bit.LOADAMODE = CMP_LOAD_MODE;	//Loads CMPA on cnt = 0 or period, see CMP_DEADLINE.
+	EPwm2Regs.CMPCTL.bit.LOADBMODE = CMP_LOAD_MODE;	//Loads CMPB with CMPA.
 	
 	EPwm2Regs.DBCTL.bit.OUT_MODE = DB_FULL_ENABLE;	//Enables Dead-band.
 	EPwm2Regs.DBCTL.bit.POLSEL = DB_ACTV_HIC;		//Dead-band is active high complementary.
@@ -672,8 +862,8 @@ void DSP_init()
 	EPwm3Regs.CMPCTL.bit.SHDWAMODE = CC_SHADOW;		//Enable Shadow register for CMPA.
 	EPwm3Regs.CMPCTL.bit.SHDWBMODE = CC_SHADOW;		//Enable Shadow register for CMPB.
 
-	EPwm3Regs.CMPCTL.bit.LOADAMODE = CC_CTR_ZERO;	//Loads CMPA on cnt = 0;
-	EPwm3Regs.CMPCTL.bit.LOADBMODE = CC_CTR_ZERO;	//Loads CMPB when cnt = 0
+	EPwm3Regs.CMPCTL.bit.LOADAMODE = CMP_LOAD_MODE;	//Loads CMPA on cnt = 0 or period, see CMP_DEADLINE.
+	EPwm3Regs.CMPCTL.bit.LOADBMODE = CMP_LOAD_MODE;	//Loads CMPB with CMPA.
 	
 	EPwm3Regs.DBCTL.bit.OUT_MODE = DB_FULL_ENABLE;	//Enables Dead-band.
 	EPwm3Regs.DBCTL.bit.POLSEL = DB_ACTV_HIC;		//Dead-band is active high complementary.
@@ -702,8 +892,8 @@ void DSP_init()
 	EPwm4Regs.CMPCTL.bit.SHDWAMODE = CC_SHADOW;		//Enable Shadow register for CMPA.
 	EPwm4Regs.CMPCTL.bit.SHDWBMODE = CC_SHADOW;		//Enable Shadow register for CMPB.
 
-	EPwm4Regs.CMPCTL.bit.LOADAMODE = CC_CTR_ZERO;	//Loads CMPA on cnt = 0;
-	EPwm4Regs.CMPCTL.bit.LOADBMODE = CC_CTR_ZERO;	//Loads CMPB when cnt = 0
+	EPwm4Regs.CMPCTL.bit.LOADAMODE = CMP_LOAD_MODE;	//Loads CMPA on cnt = 0 or period, see CMP_DEADLINE.
+	EPwm4Regs.CMPCTL.bit.LOADBMODE = CMP_LOAD_MODE;	//Loads CMPB with CMPA.
 	
 	EPwm4Regs.DBCTL.bit.OUT_MODE = DB_FULL_ENABLE;	//Enables Dead-band.
 	EPwm4Regs.DBCTL.bit.POLSEL = DB_ACTV_HIC;		//Dead-band is active high complementary.
@@ -732,8 +922,8 @@ void DSP_init()
 	EPwm5Regs.CMPCTL.bit.SHDWAMODE = CC_SHADOW;		//Enable Shadow register for CMPA.
 	EPwm5Regs.CMPCTL.bit.SHDWBMODE = CC_SHADOW;		//Enable Shadow register for CMPB.
 
-	EPwm5Regs.CMPCTL.bit.LOADAMODE = CC_CTR_ZERO;	//Loads CMPA on cnt = 0;
-	EPwm5Regs.CMPCTL.bit.LOADBMODE = CC_CTR_ZERO;	//Loads CMPB when cnt = 0
+	EPwm5Regs.CMPCTL.bit.LOADAMODE = CMP_LOAD_MODE;	//Loads CMPA on cnt = 0 or period, see CMP_DEADLINE.
+	EPwm5Regs.CMPCTL.bit.LOADBMODE = CMP_LOAD_MODE;	//Loads CMPB with CMPA.
 	
 	EPwm5Regs.DBCTL.bit.OUT_MODE = DB_FULL_ENABLE;	//Enables Dead-band.
 	EPwm5Regs.DBCTL.bit.POLSEL = DB_ACTV_HIC;		//Dead-band is active high complementary.
@@ -762,8 +952,8 @@ void DSP_init()
 	EPwm6Regs.CMPCTL.bit.SHDWAMODE = CC_SHADOW;		//Enable Shadow register for CMPA.
 	EPwm6Regs.CMPCTL.bit.SHDWBMODE = CC_SHADOW;		//Enable Shadow register for CMPB.
 
-	EPwm6Regs.CMPCTL.bit.LOADAMODE = CC_CTR_ZERO;	//Loads CMPA on cnt = 0;
-	EPwm6Regs.CMPCTL.bit.LOADBMODE = CC_CTR_ZERO;	//Loads CMPB when cnt = 0
+	EPwm6Regs.CMPCTL.bit.LOADAMODE = CMP_LOAD_MODE;	//Loads CMPA on cnt = 0 or period, see CMP_DEADLINE.
+	EPwm6Regs.CMPCTL.bit.LOADBMODE = CMP_LOAD_MODE;	//Loads CMPB with CMPA.
 	
 	EPwm6Regs.DBCTL.bit.OUT_MODE = DB_FULL_ENABLE;	//Enables Dead-band.
 	EPwm6Regs.DBCTL.bit.POLSEL = DB_ACTV_HIC;		//Dead-band is active high complementary.
@@ -787,13 +977,15 @@ void DSP_init()
 
 	//********************************************************
 	//ADC Module Set UP:
-	//	-Cascaded Sequential Mode. 
+	//	-Cascaded Sequential Mode, or Simultaneous Mode (A_n/B_n pairs) with ADC_SIMULTANEOUS.
 	//	-CSP is 1, therefore the ADC clock is HSPCLK/2 = 12.5 MHz.
 	//	-S/H is 1 ADC Clock cycle (80 ns)
 	//
 	//	-At 12.5 Msps, 16 channels/sequence, sample rate can be up to 781,250/second/channel.
+	//	-Simultaneous Mode converts the 16 channels as 8 pairs, half the sequence time.
 	//
-	//	-ADC interrupt is given in adc_isr().
+	//	-ADC interrupt is given in adc_isr(), or runs timer_isr() when ADC_SOCA_TRIGGER is set.
+	//	-With ADC_DMA, DMA CH1 collects the sequences and its interrupt runs timer_isr() instead.
 	//	-ADC clock is enabled already.
 	
    #if (CPU_FRQ_150MHZ)     // Default - 150 MHz SYSCLKOUT
@@ -803,13 +995,28 @@ void DSP_init()
      #define ADC_MODCLK 0x2 // HSPCLK = SYSCLKOUT/2*ADC_MODCLK2 = 100/(2*2)   = 25.0 MHz
    #endif
    
+#if(ADC_DMA)
+	PieVectTable.ADCINT = &adc_isr;					//Not enabled, SEQ1INT only triggers the DMA.
+	PieVectTable.DINTCH1 = &timer_isr;				//Control code runs when the DMA transfer is done.
+#elif(ADC_SOCA_TRIGGER)
+	PieVectTable.ADCINT = &timer_isr;				//Control code runs when SEQ1 has finished.
+#else
 	PieVectTable.ADCINT = &adc_isr;					//Assign ISR
+#endif
 	AdcRegs.ADCTRL3.all = 0x00E0; 					//Power up everything.
 	DELAY_US(100000);					    		//Need at least 5ms delay.  giving 10ms.
 
+#if(ADC_DMA)
+	PieCtrlRegs.PIEIER7.bit.INTx1 = 0x1;			//PIE Interrupt Enable, DINTCH1 is group 7 int 1.
+	IER |= M_INT7; 									//Enable CPU Interrupt 7 (PIE Set 7).
+#elif(ADC_SOCA_TRIGGER)
+	PieCtrlRegs.PIEIER1.bit.INTx6 = 0x1;			//PIE Interrupt Enable
+	IER |= M_INT1; 									//Enable CPU Interrupt 1 (PIE Set 1).
+#else
 	PieCtrlRegs.PIEIER1.bit.INTx6 = 0x1;			//PIE Interrupt Enable
 	//IER |= M_INT1; 								//Enable CPU Interrupt 1 (PIE Set 1).
 	IER |= M_INT3;									// Enable CPU INT3 which is connected to EPWM1-6 INT:
+#endif
 	EINT;		   									//Enable Global interrupt INTM
 	ERTM;		   									//Enable Global reatime interrupt DBGM.
 	
@@ -817,6 +1024,35 @@ void DSP_init()
 	AdcRegs.ADCTRL1.bit.CPS = 0x1;					//CPS scaling is 2.
 	AdcRegs.ADCTRL1.bit.ACQ_PS = 0x0;				//Sample-Hold Pulse is 1 ADCCLK (80ns)
 	
+#if(ADC_SIMULTANEOUS)
+	//Set up conversions.  Slot k converts pair A_n/B_n (n = CONVk) into ADCRESULT(2k)/(2k+1).
+	AdcRegs.ADCTRL3.bit.SMODE_SEL = 0x1;			//Simultaneous sampling.
+	AdcRegs.ADCMAXCONV.bit.MAX_CONV1 = 0x7;			//8 pairs (16 results) per sequence.
+	AdcRegs.ADCMAXCONV.bit.MAX_CONV2 = 0x0;			//Read 1 ADC Result.
+	
+	AdcRegs.ADCTRL1.bit.CONT_RUN = 0x0;				//Continuous conversion is off.  MUST RESET in ADC ISR.
+	AdcRegs.ADCTRL1.bit.SEQ_CASC = 0x1;				//Cascaded sequencer.
+	
+	AdcRegs.ADCREFSEL.bit.REF_SEL = 0x00;			//Internal Reference.
+	
+	//Slots 8-15 repeat 0-7 so a sequencer that was not reset still converts the same pairs.
+	AdcRegs.ADCCHSELSEQ1.bit.CONV00 = 0;			//Slot 0 is ADCINA0/B0;
+	AdcRegs.ADCCHSELSEQ1.bit.CONV01 = 2;			//Slot 1 is ADCINA2/B2;
+	AdcRegs.ADCCHSELSEQ1.bit.CONV02 = 1;			//Slot 2 is ADCINA1/B1;
+	AdcRegs.ADCCHSELSEQ1.bit.CONV03 = 3;			//Slot 3 is ADCINA3/B3;
+	AdcRegs.ADCCHSELSEQ2.bit.CONV04 = 6;			//Slot 4 is ADCINA6/B6;
+	AdcRegs.ADCCHSELSEQ2.bit.CONV05 = 4;			//Slot 5 is ADCINA4/B4;
+	AdcRegs.ADCCHSELSEQ2.bit.CONV06 = 5;			//Slot 6 is ADCINA5/B5;
+	AdcRegs.ADCCHSELSEQ2.bit.CONV07 = 7;			//Slot 7 is ADCINA7/B7;
+	AdcRegs.ADCCHSELSEQ3.bit.CONV08 = 0;
+	AdcRegs.ADCCHSELSEQ3.bit.CONV09 = 2;
+	AdcRegs.ADCCHSELSEQ3.bit.CONV10 = 1;
+	AdcRegs.ADCCHSELSEQ3.bit.CONV11 = 3;
+	AdcRegs.ADCCHSELSEQ4.bit.CONV12 = 6;
+	AdcRegs.ADCCHSELSEQ4.bit.CONV13 = 4;
+	AdcRegs.ADCCHSELSEQ4.bit.CONV14 = 5;
+	AdcRegs.ADCCHSELSEQ4.bit.CONV15 = 7;
+#else
 	//Set up conversions.
 	AdcRegs.ADCMAXCONV.bit.MAX_CONV1 = 0xF;			//16 conversions per sequence.
 	AdcRegs.ADCMAXCONV.bit.MAX_CONV2 = 0x0;			//Read 1 ADC Result.
@@ -843,7 +1079,15 @@ void DSP_init()
 	AdcRegs.ADCCHSELSEQ4.bit.CONV14 = 14;			//ADC Result 14 is ADCINA14;
 	AdcRegs.ADCCHSELSEQ4.bit.CONV15 = 15;			//ADC Result 15 is ADCINA15;
 							
+#endif
 	AdcRegs.ADCTRL2.bit.INT_ENA_SEQ1 = 1;			//Enable interrupt request.	
+#if(ADC_SOCA_TRIGGER)
+	AdcRegs.ADCTRL2.bit.EPWM_SOCA_SEQ1 = 1;			//SEQ1 is started by EPwm1 SOCA.
+#endif
+#if(ADC_DMA)
+	InitAdcDma();									//Extra SOC events and DMA CH1.
+#endif
+	InitProfile();									//CPU Timer 1 free running for the ISR profiler.
 	
 	
 	/*************************************
@@ -878,21 +1122,26 @@ void DSP_init()
 	CpuTimer0Regs.TCR.bit.TSS = 0x1;					//Timer starts of halted.
 	CpuTimer0Regs.TPR.all = 0x0;						//Prescaler is 0.
 	//PieVectTable.TINT0 = &timer_isr;					//Assign timer_isr function to the PIE interrupt vector.
+#if(!ADC_SOCA_TRIGGER)
 	PieVectTable.EPWM1_INT = &timer_isr;				//Assign timer_isr function to EPWM1 interrupt
 	//PieCtrlRegs.PIEIER1.bit.INTx7 = 1;				//Enable TINT0, group 1 int 7.
     PieCtrlRegs.PIEIER3.bit.INTx1 = 1;    				// Enable EPWM INTn in the PIE: Group 3 interrupt 1
+#endif
 
 	EDIS;
 	
 	/***********************************
 	 * I2C Setup for DAC.
-	 * We run in FIFO mode, no interrupts.
+	 * We run in FIFO mode, the stop condition interrupt starts the next
+	 * queued DAC channel (see ECI_I2cDac.h).
 	 */
    	I2caRegs.I2CSAR = DAC_ADDRESS;		// Slave address - DAC
     I2caRegs.I2CPSC.all = 14;   			// Prescaler - need 7-12 Mhz on module clk (150/15 = 10MHz)
    	I2caRegs.I2CCLKL = 15;					// SCL High Counter -> Together SCL freq = 312.5 KHz.
    	I2caRegs.I2CCLKH = 7;					// SCL Low Counter -> 
-   	I2caRegs.I2CIER.all = 0x0000;			// No interrupts
+   	I2caRegs.I2CIER.all = 0x0000;
+   	I2caRegs.I2CIER.bit.NACK = 0x1;			// No acknowledge, counted and stopped.
+   	I2caRegs.I2CIER.bit.SCD = 0x1;			// Stop condition, end of a DAC transaction.
    	I2caRegs.I2CMDR.bit.FREE = 0x1;			//Run Free! (during debug break)
    	I2caRegs.I2CMDR.bit.MST = 0x1;			//Master Mode
    	I2caRegs.I2CMDR.bit.TRX = 0x1;			// Transmitter mode.
@@ -904,7 +1153,13 @@ void DSP_init()
    											// Take I2C out of reset
    											// Stop I2C when suspended
   
-   I2caRegs.I2CFFTX.bit.TXFFINTCLR = 0x1;	//Reset the interrupt, even though we're not using it.
+   I2caRegs.I2CFFTX.bit.TXFFINTCLR = 0x1;	//Reset the FIFO interrupt, not used.
+
+   EALLOW;
+   PieVectTable.I2CINT1A = &i2c_dac_isr;
+   EDIS;
+   PieCtrlRegs.PIEIER8.bit.INTx1 = 1;		// I2CINT1A is group 8 interrupt 1.
+   IER |= M_INT8;
 }
 #endif  // end of ECI_API definition
 
@@ -0,0 +1,177 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: ECI_AdcDma.h
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		DMA ping-pong capture of the ADC with per-period oversampling.  Used when
+ * 		ADC_DMA = 1 in ECI_API.h.
+ *
+ * 		ADC_OVERSAMPLE SEQ1 bursts (16 channels each) are started per PWM period by
+ * 		ePWM SOC events spread evenly over the up-down carrier:
+ *
+ * 			OS = 1:	EPwm1 SOCA at zero.
+ * 			OS = 2:	+ EPwm1 SOCB at period.
+ * 			OS = 4:	+ EPwm2 SOCA/SOCB at CMPB = PWM_PD/2 (up and down).
+ * 			OS = 8:	+ EPwm3 SOCA/SOCB at CMPB = PWM_PD/4 and
+ * 					  EPwm4 SOCA/SOCB at CMPB = 3*PWM_PD/4 (up and down).
+ *
+ * 		CMPB is free on every module because the B outputs come from the dead-band
+ * 		unit (DB_FULL_ENABLE, A as source).  DMA CH1 copies each burst from the ADC
+ * 		result mirror on SEQ1INT into one half of AdcDmaBuf.  After OS bursts the
+ * 		channel interrupt (DINTCH1) runs timer_isr(), which points the DMA at the
+ * 		other half and averages the finished one into AdcAin[] for GetAIN_xx().
+ *
+ * 		The ISR starts one burst after the last SOC, so the compares cannot be
+ * 		loaded at the next zero as with one SOC per period.  From OS = 4 on the
+ * 		last SOC is in the down-count half and the compares load at period
+ * 		instead (CMP_LOAD_MODE in ECI_API.h).  The budget from the last SOC to
+ * 		the compare load, CMP_DEADLINE, which holds the last burst, the interrupt
+ * 		latency and the control code up to the compare writes:
+ *
+ * 			OS = 1, 2:	one period, 2*PWM_PD (50 us).
+ * 			OS = 4:		3/4 period, 3*PWM_PD/2 (37.5 us), load at period.
+ * 			OS = 8:		5/8 period, 5*PWM_PD/4 (31.25 us), load at period.
+ *
+ * 		ECI_Load.h measures it per tick (IsrDeadline, IsrLate).
+ *
+ * 		With all 16 states used (MAX_CONV1 = 15) the sequencer wraps to CONV00 at
+ * 		the end of each burst, so no CPU reset is needed between bursts.  In
+ * 		simultaneous mode (MAX_CONV1 = 7) the next burst runs CONV08-15, which
+ * 		repeat CONV00-07.  The sequencer is still reset once per period in
+ * 		AdcDmaSwap() to stay aligned.
+ * *****************************************************************************
+ */
+
+#ifndef ECI_ADCDMA_H
+#define ECI_ADCDMA_H
+
+#define ADC_CHANNELS 16				//Results per SEQ1 burst (16 conversions or 8 simultaneous pairs).
+#define ADC_DMA_WORDS (ADC_CHANNELS*ADC_OVERSAMPLE)	//Words per ping-pong half.
+
+#if(ADC_OVERSAMPLE != 1 && ADC_OVERSAMPLE != 2 && ADC_OVERSAMPLE != 4 && ADC_OVERSAMPLE != 8)
+	#error "ADC_OVERSAMPLE must be 1, 2, 4 or 8."
+#endif
+
+#pragma DATA_SECTION(AdcDmaBuf, "DMARAML6")			//DMA can only reach L4-L7.
+Uint16 AdcDmaBuf[2][ADC_DMA_WORDS];					//Ping-pong halves, [burst*16 + result].
+Uint16 AdcDmaHalf = 0;								//Half the DMA is filling now.
+float32 AdcAin[ADC_CHANNELS];						//Period average of each result, right aligned.
+													//	Indexed by result, see AIN_A()/AIN_B().
+
+//AdcDmaSwap(): Points the DMA at the other half for the next period and returns the finished one.
+//	Must run before the first SOC of the next period, the shadow address is loaded at that SOC.
+inline Uint16 *AdcDmaSwap()
+{
+	Uint16 *done = AdcDmaBuf[AdcDmaHalf];
+
+	AdcDmaHalf ^= 1;
+	EALLOW;
+	DmaRegs.CH1.DST_BEG_ADDR_SHADOW = (Uint32)AdcDmaBuf[AdcDmaHalf];
+	DmaRegs.CH1.DST_ADDR_SHADOW = (Uint32)AdcDmaBuf[AdcDmaHalf];
+	EDIS;
+
+	AdcRegs.ADCTRL2.bit.RST_SEQ1 = 1;				//Re-align the sequencer once per period.
+	AdcRegs.ADCST.bit.INT_SEQ1_CLR = 1;				//Clear SEQ1 interrupt flag.
+	return done;
+}
+
+//AdcDmaAverage(): Averages the ADC_OVERSAMPLE bursts of one half into AdcAin[].
+//	The sum of 8 12-bit results still fits a Uint16.
+inline void AdcDmaAverage(const Uint16 *buf)
+{
+	Uint16 ch, os;
+	Uint16 sum;
+
+	for(ch = 0; ch < ADC_CHANNELS; ch++)
+	{
+		sum = 0;
+		for(os = 0; os < ADC_OVERSAMPLE; os++)
+			sum += buf[os*ADC_CHANNELS + ch];
+		AdcAin[ch] = (float32)sum*(1.0f/ADC_OVERSAMPLE);
+	}
+}
+
+//InitAdcDma(): Sets up the extra ePWM SOC events and DMA CH1.  Call from DSP_init() under EALLOW,
+//	after the ePWM and ADC set up.
+void InitAdcDma()
+{
+	//ePWM SOC events, all ORed into SEQ1 (SOCA via EPWM_SOCA_SEQ1, SOCB via EPWM_SOCB_SEQ).
+#if(ADC_OVERSAMPLE >= 2)
+	EPwm1Regs.ETSEL.bit.SOCBSEL = ET_CTR_PRD;		//Period.
+	EPwm1Regs.ETSEL.bit.SOCBEN = 1;
+	EPwm1Regs.ETPS.bit.SOCBPRD = ET_1ST;
+#endif
+#if(ADC_OVERSAMPLE >= 4)
+	EPwm2Regs.CMPB = PWM_PD/2;						//Half way up and half way down.
+	EPwm2Regs.ETSEL.bit.SOCASEL = ET_CTRU_CMPB;
+	EPwm2Regs.ETSEL.bit.SOCAEN = 1;
+	EPwm2Regs.ETPS.bit.SOCAPRD = ET_1ST;
+	EPwm2Regs.ETSEL.bit.SOCBSEL = ET_CTRD_CMPB;
+	EPwm2Regs.ETSEL.bit.SOCBEN = 1;
+	EPwm2Regs.ETPS.bit.SOCBPRD = ET_1ST;
+#endif
+#if(ADC_OVERSAMPLE >= 8)
+	EPwm3Regs.CMPB = PWM_PD/4;						//Quarter way up and down.
+	EPwm3Regs.ETSEL.bit.SOCASEL = ET_CTRU_CMPB;
+	EPwm3Regs.ETSEL.bit.SOCAEN = 1;
+	EPwm3Regs.ETPS.bit.SOCAPRD = ET_1ST;
+	EPwm3Regs.ETSEL.bit.SOCBSEL = ET_CTRD_CMPB;
+	EPwm3Regs.ETSEL.bit.SOCBEN = 1;
+	EPwm3Regs.ETPS.bit.SOCBPRD = ET_1ST;
+
+	EPwm4Regs.CMPB = (3*PWM_PD)/4;					//Three quarters way up and down.
+	EPwm4Regs.ETSEL.bit.SOCASEL = ET_CTRU_CMPB;
+	EPwm4Regs.ETSEL.bit.SOCAEN = 1;
+	EPwm4Regs.ETPS.bit.SOCAPRD = ET_1ST;
+	EPwm4Regs.ETSEL.bit.SOCBSEL = ET_CTRD_CMPB;
+	EPwm4Regs.ETSEL.bit.SOCBEN = 1;
+	EPwm4Regs.ETPS.bit.SOCBPRD = ET_1ST;
+#endif
+#if(ADC_OVERSAMPLE >= 2)
+	AdcRegs.ADCTRL2.bit.EPWM_SOCB_SEQ = 1;			//SOCB also starts the cascaded sequencer.
+#endif
+
+	//DMA CH1: one 16 word burst per SEQ1INT, ADC_OVERSAMPLE bursts per transfer.
+	DmaRegs.DMACTRL.bit.HARDRESET = 1;
+	asm(" NOP");									//One cycle after HARDRESET before any DMA write.
+
+	DmaRegs.CH1.SRC_BEG_ADDR_SHADOW = (Uint32)&AdcMirror.ADCRESULT0;	//Right aligned results.
+	DmaRegs.CH1.SRC_ADDR_SHADOW = (Uint32)&AdcMirror.ADCRESULT0;
+	DmaRegs.CH1.DST_BEG_ADDR_SHADOW = (Uint32)AdcDmaBuf[0];
+	DmaRegs.CH1.DST_ADDR_SHADOW = (Uint32)AdcDmaBuf[0];
+
+	DmaRegs.CH1.BURST_SIZE.all = ADC_CHANNELS - 1;	//16 words per burst.
+	DmaRegs.CH1.SRC_BURST_STEP = 1;
+	DmaRegs.CH1.DST_BURST_STEP = 1;
+	DmaRegs.CH1.TRANSFER_SIZE = ADC_OVERSAMPLE - 1;	//OS bursts per transfer.
+	DmaRegs.CH1.SRC_TRANSFER_STEP = 0;				//Source is rewound by the wrap below.
+	DmaRegs.CH1.DST_TRANSFER_STEP = 1;				//Next burst follows the last one.
+	DmaRegs.CH1.SRC_WRAP_SIZE = 0;					//Wrap after every burst...
+	DmaRegs.CH1.SRC_WRAP_STEP = 0;					//...back to ADCRESULT0.
+	DmaRegs.CH1.DST_WRAP_SIZE = 0xFFFF;				//No destination wrap.
+	DmaRegs.CH1.DST_WRAP_STEP = 0;
+
+	DmaRegs.CH1.MODE.bit.PERINTSEL = DMA_SEQ1INT;	//Burst on SEQ1 end of sequence.
+	DmaRegs.CH1.MODE.bit.PERINTE = PERINT_ENABLE;
+	DmaRegs.CH1.MODE.bit.ONESHOT = ONESHOT_DISABLE;	//One burst per SEQ1INT.
+	DmaRegs.CH1.MODE.bit.CONTINUOUS = CONT_ENABLE;	//Re-arm after each transfer.
+	DmaRegs.CH1.MODE.bit.SYNCE = SYNC_DISABLE;
+	DmaRegs.CH1.MODE.bit.DATASIZE = SIXTEEN_BIT;
+	DmaRegs.CH1.MODE.bit.OVRINTE = OVRFLOW_DISABLE;
+	DmaRegs.CH1.MODE.bit.CHINTMODE = CHINT_END;		//timer_isr() once all bursts are in.
+	DmaRegs.CH1.MODE.bit.CHINTE = CHINT_ENABLE;
+
+	DmaRegs.CH1.CONTROL.bit.PERINTCLR = 1;
+	DmaRegs.CH1.CONTROL.bit.SYNCCLR = 1;
+	DmaRegs.CH1.CONTROL.bit.ERRCLR = 1;
+	DmaRegs.CH1.CONTROL.bit.RUN = 1;
+}
+
+#endif /*ECI_ADCDMA_H*/
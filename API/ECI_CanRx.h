@@ -0,0 +1,132 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: ECI_CanRx.h
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		Interrupt driven eCAN-A receive.  Each receive mailbox is given a handler
+ * 		with InitCanRxMbox().  The mailbox interrupt (ECAN0INTA, PIE group 9 INT5)
+ * 		runs ecan0_isr(), which calls the handler of every mailbox with new data
+ * 		and then clears its RMP flag.  Commands no longer wait for the main loop.
+ *
+ * 		With CAN_RX_NESTED = 1 in ECI_API.h, AllowCanRx() at the start of
+ * 		timer_isr() lets ECAN0INTA, and only ECAN0INTA, preempt the control ISR.
+ * 		A PWM disable then reaches the enable GPIO about 1 us after the message,
+ * 		even when the control ISR is running.  Handlers are short and must not
+ * 		touch state that timer_isr() is partway through writing.
+ *
+ * 		InitCanTxMbox() and SendCanMbox() set up and load transmit mailboxes for
+ * 		the replies.
+ *
+ * 		All eCAN register writes are 32-bit, as the module requires.
+ *
+ * 		ex:	void RxEnable(volatile struct MBOX *mb) {...}
+ * 			InitCanRxMbox(1, 0x10000000, RxEnable);		//after InitECan()
+ * 			InitCanRx();
+ * *****************************************************************************
+ */
+
+#ifndef ECI_CANRX_H
+#define ECI_CANRX_H
+
+#define CAN_MBOXES 32
+#define CAN_GMIF0 0x00008000		//CANGIF0 global mailbox interrupt flag.
+#define CAN_MIV0 0x0000001F			//CANGIF0 mailbox interrupt vector.
+
+typedef void (*CAN_HANDLER)(volatile struct MBOX *mb);
+
+CAN_HANDLER CanRxHandler[CAN_MBOXES] = {0};	//Per mailbox, 0 = no handler.
+Uint32 CanRxCount = 0;						//Messages dispatched.
+
+//ecan0_isr(): ECAN0INTA, dispatches every mailbox with new data to its handler.
+interrupt void ecan0_isr(void)
+{
+	Uint32 gif;
+	Uint16 n;
+
+	while((gif = ECanaRegs.CANGIF0.all) & CAN_GMIF0)
+	{
+		n = (Uint16)(gif & CAN_MIV0);							//highest mailbox with new data
+		if(CanRxHandler[n]) CanRxHandler[n](&(&ECanaMboxes.MBOX0)[n]);
+		ECanaRegs.CANRMP.all = (Uint32)1 << n;				//write 1 to clear, also clears GMIF0 when it was the last
+		CanRxCount++;
+	}
+	PieCtrlRegs.PIEACK.all = PIEACK_GROUP9;					//ECAN0INTA is group 9.
+}
+
+//InitCanRxMbox(): Mailbox n receives extended ID id and calls h on each message.  Call after InitECan().
+void InitCanRxMbox(Uint16 n, Uint32 id, CAN_HANDLER h)
+{
+	Uint32 bit = (Uint32)1 << n;
+	volatile struct MBOX *mb = &(&ECanaMboxes.MBOX0)[n];
+
+	CanRxHandler[n] = h;
+	ECanaRegs.CANME.all &= ~bit;					//ID can only be changed while disabled
+	mb->MSGID.all = id;								// message Identifier
+	mb->MSGID.bit.IDE = 1;							//extended identifier
+	ECanaRegs.CANMD.all |= bit;						//mailbox direction to receive
+	EALLOW;
+	ECanaRegs.CANMIL.all &= ~bit;					//interrupt line 0, ECAN0INTA
+	ECanaRegs.CANMIM.all |= bit;					//interrupt on receive
+	EDIS;
+	ECanaRegs.CANME.all |= bit;						//enable mailbox
+}
+
+//InitCanRx(): Enables ECAN0INTA.  Call once the mailboxes are set up.
+void InitCanRx()
+{
+	EALLOW;
+	PieVectTable.ECAN0INTA = &ecan0_isr;
+	ECanaRegs.CANGIM.all |= 0x00000001;				//I0EN, mailbox interrupts on line 0
+	EDIS;
+	PieCtrlRegs.PIEIER9.bit.INTx5 = 1;				//ECAN0INTA is group 9 interrupt 5.
+	IER |= M_INT9;
+}
+
+//InitCanTxMbox(): Mailbox n transmits 8 bytes with extended ID id.  Call after InitECan().
+void InitCanTxMbox(Uint16 n, Uint32 id)
+{
+	Uint32 bit = (Uint32)1 << n;
+	volatile struct MBOX *mb = &(&ECanaMboxes.MBOX0)[n];
+
+	ECanaRegs.CANME.all &= ~bit;
+	mb->MSGID.all = id;
+	mb->MSGID.bit.IDE = 1;
+	mb->MSGCTRL.all = 0;
+	mb->MSGCTRL.bit.DLC = 8;
+	ECanaRegs.CANMD.all &= ~bit;					//mailbox direction to transmit
+	ECanaRegs.CANME.all |= bit;
+}
+
+//SendCanMbox(): Sends mdl (bytes 0-3) and mdh (bytes 4-7) from mailbox n.  Returns 1, and sends
+//	nothing, while the last message of n is still waiting for the bus.
+Uint16 SendCanMbox(Uint16 n, Uint32 mdl, Uint32 mdh)
+{
+	Uint32 bit = (Uint32)1 << n;
+	volatile struct MBOX *mb = &(&ECanaMboxes.MBOX0)[n];
+
+	if(ECanaRegs.CANTRS.all & bit) return 1;
+	mb->MDL.all = mdl;
+	mb->MDH.all = mdh;
+	ECanaRegs.CANTA.all = bit;						//write 1 to clear the last acknowledge
+	ECanaRegs.CANTRS.all = bit;						//request transmission
+	return 0;
+}
+
+//AllowCanRx(): First lines of timer_isr(), lets ECAN0INTA preempt it when CAN_RX_NESTED = 1.
+//	IER and INTM are restored by the return from interrupt.
+inline void AllowCanRx()
+{
+#if(CAN_RX_NESTED)
+	IER = M_INT9;
+	EINT;
+#endif
+}
+
+#endif /*ECI_CANRX_H*/
@@ -0,0 +1,212 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: ECI_Capture.h
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		Golden-vector capture of the ISR inputs and outputs, for replay of the
+ * 		same ticks through the control code on the host (host/golden.c).  One
+ * 		CAP_FRAME per tick in CapBuf (section "capbuf", RAML6 next to the DMA
+ * 		buffer):
+ *
+ * 			adc[]		the 16 ADC results the tick used: the sum of the
+ * 						ADC_OVERSAMPLE bursts with ADC_DMA (exact, AdcAin[] is
+ * 						sum/ADC_OVERSAMPLE), else the right aligned result.
+ * 			flags		CAP_F_x: CAN enables, parameter commit, IsrSkip.
+ * 			cmpa[]		EPwm1-6 CMPA after the control code.
+ *
+ * 		A parameter commit is logged ahead of the frames, one CAP_PARAM per value
+ * 		that changed, so the replay can write and commit the same values before
+ * 		that frame.  A commit that does not fit in the CAP_PARAMS entries marks
+ * 		its frame CAP_F_PARAM_LOST, and the replay stops comparing there.
+ *
+ * 		CaptureArm() is run by InitCtrl(), so after every reset CapBuf holds the
+ * 		first CAP_FRAMES ticks from the cleared controller state, and replays
+ * 		exactly from a fresh boot.  Set CapArmReq = 1 from the debugger to record
+ * 		again, the header start words are then the tick count at the first
+ * 		frame.  The controller state at that tick is not saved, so golden
+ * 		refuses to replay such a capture, it is for viewing only.  Once CapState
+ * 		is CAP_DONE, save CapBuf from the debugger (CCS Memory Save, 16-bit hex,
+ * 		length sizeof(CapBuf)) and pass the .dat file to golden.
+ *
+ * 		CAP_HDR and CAP_FRAME are all Uint16, so the words are laid out the
+ * 		same on the C28x and the host.  With CAPTURE = 0 in ECI_API.h all calls
+ * 		are empty inlines, with CAP_LAYOUT_ONLY defined only the types are
+ * 		declared.
+ *
+ * 		ex:	CaptureArm(RackId);				//InitCtrl()
+ * 			...
+ * 			CaptureSample(CAP_F_AFE);		//in timer_isr(), after the compares are written
+ * *****************************************************************************
+ */
+
+#ifndef ECI_CAPTURE_H
+#define ECI_CAPTURE_H
+
+#ifndef CAP_FRAMES
+#define CAP_FRAMES 168				//Ticks recorded (8.4 ms), fills RAML6 with the DMA buffer.
+#endif
+#define CAP_MAGIC 0xCA02			//CAP_HDR.magic, changes with the layout.
+#define CAP_PARAMS 8				//Parameter changes logged, 4 words each.
+#define CAP_ADC 16					//ADCRESULT0-15
+#define CAP_PWM 6					//EPwm1-6
+
+#define CAP_OFF 0					//Not recording, CaptureSample() counts ticks only.
+#define CAP_DONE 1					//CapBuf full.
+#define CAP_ARMED 2					//Recording.
+
+#define CAP_F_AFE 0x0001			//AFEenable == 1
+#define CAP_F_INV 0x0002			//INVenable == 1
+#define CAP_F_NPC 0x0004			//NPCenable == 1
+#define CAP_F_PARAM 0x0008			//A parameter commit went live this tick, see CAP_PARAM.
+#define CAP_F_PARAM_LOST 0x0010		//Some of its changes did not fit in the log, not replayable.
+#define CAP_F_SKIP_SHIFT 8			//IsrSkip (DEGRADE_x) in the high byte.
+
+//Start of CapBuf.
+typedef struct
+{
+	Uint16 magic;					//CAP_MAGIC
+	Uint16 frame_words;				//Words per CAP_FRAME.
+	Uint16 oversample;				//ADC bursts summed in adc[], 1 without ADC_DMA.
+	Uint16 rack;					//RackId
+	Uint16 frames;					//Frames recorded.
+	Uint16 start_hi;				//Ticks since boot at the first frame, 0 for the boot
+	Uint16 start_lo;				//	capture, the only one golden replays.  Two words, no padding.
+	Uint16 params;					//CAP_PARAM entries logged.
+} CAP_HDR;
+
+//One parameter value that changed with a commit.
+typedef struct
+{
+	Uint16 frame;					//Frame the commit went live in.
+	Uint16 index;					//Parameter number.
+	Uint16 val_hi;					//PARAM_VAL.u, high word.
+	Uint16 val_lo;
+} CAP_PARAM;
+
+//One tick.
+typedef struct
+{
+	Uint16 adc[CAP_ADC];
+	Uint16 flags;					//CAP_F_x
+	Uint16 cmpa[CAP_PWM];
+} CAP_FRAME;
+
+typedef struct
+{
+	CAP_HDR hdr;
+	CAP_PARAM p[CAP_PARAMS];
+	CAP_FRAME f[CAP_FRAMES];
+} CAP_BUF;
+
+#ifndef CAP_LAYOUT_ONLY				//Set by host/golden.c, which only reads captures.
+#if(CAPTURE)
+
+#pragma DATA_SECTION(CapBuf, "capbuf")
+CAP_BUF CapBuf;
+volatile Uint16 CapArmReq = 0;			//Set from the debugger to run CaptureArm() from the main loop.
+volatile Uint16 CapState = CAP_OFF;	//CAP_x
+Uint32 CapTick = 0;					//CaptureSample() calls since boot.
+Uint16 CapCommits = 0;				//ParamCommits at the last frame.
+PARAM_VAL CapParamLast[PARAM_MAX];	//Live set at the last commit, for the changes.
+
+//CaptureArm(): Clears CapBuf and records from the next tick.  Not from the ISR.
+void CaptureArm(Uint16 rack)
+{
+	CAP_HDR *h = &CapBuf.hdr;
+	Uint16 k;
+
+	CapState = CAP_OFF;
+	CapArmReq = 0;
+	h->magic = CAP_MAGIC;
+	h->frame_words = sizeof(CAP_FRAME)/sizeof(Uint16);
+#if(ADC_DMA)
+	h->oversample = ADC_OVERSAMPLE;
+#else
+	h->oversample = 1;
+#endif
+	h->rack = rack;
+	h->frames = 0;
+	h->start_hi = CapTick >> 16;
+	h->start_lo = CapTick & 0xFFFF;
+	h->params = 0;
+	CapCommits = ParamCommits;
+	for(k = 0; k < ParamCount; k++) CapParamLast[k] = ParamLiveSet()[k];
+	CapState = CAP_ARMED;
+}
+
+//CaptureParams(): Logs the parameters that changed with the commit live in frame.  Returns
+//	CAP_F_PARAM_LOST if the log was full.
+Uint16 CaptureParams(Uint16 frame)
+{
+	const PARAM_VAL *p = ParamLiveSet();
+	CAP_PARAM *e;
+	Uint16 i, lost = 0;
+
+	for(i = 0; i < ParamCount; i++)
+	{
+		if(p[i].u == CapParamLast[i].u) continue;
+		CapParamLast[i] = p[i];
+		if(CapBuf.hdr.params >= CAP_PARAMS)
+		{
+			lost = CAP_F_PARAM_LOST;
+			continue;
+		}
+		e = &CapBuf.p[CapBuf.hdr.params++];
+		e->frame = frame;
+		e->index = i;
+		e->val_hi = p[i].u >> 16;
+		e->val_lo = p[i].u & 0xFFFF;
+	}
+	return lost;
+}
+
+//CaptureSample(): Records one frame, flags are the CAP_F_AFE/INV/NPC enables.  Call once per ISR,
+//	after the compares are written and on degraded ticks too.
+inline void CaptureSample(Uint16 flags)
+{
+	CAP_FRAME *f;
+	Uint16 k;
+
+	CapTick++;
+	if(CapState != CAP_ARMED) return;
+
+	f = &CapBuf.f[CapBuf.hdr.frames];
+	for(k = 0; k < CAP_ADC; k++)
+#if(ADC_DMA)
+		f->adc[k] = (Uint16)(AdcAin[k]*ADC_OVERSAMPLE);
+#else
+		f->adc[k] = ADC_RESULT(k) >> 4;
+#endif
+	if(ParamCommits != CapCommits)
+	{
+		flags |= CAP_F_PARAM | CaptureParams(CapBuf.hdr.frames);
+		CapCommits = ParamCommits;
+	}
+	f->flags = flags | (IsrSkip << CAP_F_SKIP_SHIFT);
+	f->cmpa[0] = EPwm1Regs.CMPA.half.CMPA;
+	f->cmpa[1] = EPwm2Regs.CMPA.half.CMPA;
+	f->cmpa[2] = EPwm3Regs.CMPA.half.CMPA;
+	f->cmpa[3] = EPwm4Regs.CMPA.half.CMPA;
+	f->cmpa[4] = EPwm5Regs.CMPA.half.CMPA;
+	f->cmpa[5] = EPwm6Regs.CMPA.half.CMPA;
+	if(++CapBuf.hdr.frames >= CAP_FRAMES) CapState = CAP_DONE;
+}
+
+#else
+
+volatile Uint16 CapArmReq;			//Stays 0.
+
+inline void CaptureArm(Uint16 rack)			{}
+inline void CaptureSample(Uint16 flags)		{}
+
+#endif /*CAPTURE*/
+#endif /*CAP_LAYOUT_ONLY*/
+
+#endif /*ECI_CAPTURE_H*/
@@ -0,0 +1,115 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: ECI_I2cDac.h
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		Interrupt driven, non-blocking writes to the four channel I2C DAC.
+ *
+ * 		QueueDAC() puts a value in the channel's slot and returns.  A newer value
+ * 		for a channel replaces the one still waiting, so a slow bus only drops
+ * 		stale updates and never backs up.  Each channel is one 3-byte transaction
+ * 		that fits the 4-deep TX FIFO in one go.  The stop condition interrupt
+ * 		(I2CINT1A, SCD) marks the end of each transaction and starts the next
+ * 		waiting channel in i2c_dac_isr().  Channels go out in order DAC1..DAC4.
+ * 		DAC4 is written with LDAC low, so a full set of four updates all outputs
+ * 		together, as before.  A NACK is counted in I2cDacNacks and ends the
+ * 		transaction with a stop.
+ *
+ * 		ex:	QueueDAC(0, 128);				//DAC1 to mid scale, returns at once
+ * 			QueueDACFromISR(0, 128);		//same from an ISR
+ * *****************************************************************************
+ */
+
+#ifndef ECI_I2CDAC_H
+#define ECI_I2CDAC_H
+
+#define DAC_CHANNELS 4
+#define I2C_ISRC_NACK 2				//I2CISRC interrupt codes.
+#define I2C_ISRC_SCD 6
+
+const Uint16 I2cDacAddr[DAC_CHANNELS] = {DAC1, DAC2, DAC3, DAC4};
+const Uint16 I2cDacCfg[DAC_CHANNELS] = {0x30, 0x30, 0x30, 0x20};	//[PD1 PD0 CLR_L LDAC_L], LDAC low on DAC4 loads all.
+
+volatile Uint16 I2cDacVal[DAC_CHANNELS];		//Value waiting per channel, 0-255.
+volatile Uint16 I2cDacPend[DAC_CHANNELS];		//1 while the channel's value has not been sent.
+volatile Uint16 I2cDacBusy;						//1 while a transaction is on the bus.
+Uint16 I2cDacNext;								//Channel checked first for the next transaction.
+Uint32 I2cDacNacks;								//Transactions not acknowledged by the DAC.
+Uint32 I2cDacSent;								//Transactions completed.
+
+//StartI2cDac(): Starts the next waiting channel, or marks the bus idle.  From i2c_dac_isr() or with
+//	interrupts disabled.
+void StartI2cDac()
+{
+	Uint16 n, k, val;
+
+	for(n = 0; n < DAC_CHANNELS; n++)
+	{
+		k = I2cDacNext;
+		I2cDacNext = (k + 1) & (DAC_CHANNELS - 1);
+		if(I2cDacPend[k])
+		{
+			I2cDacPend[k] = 0;								//clear first, a QueueDAC() after this is sent again
+			val = I2cDacVal[k];
+
+			I2caRegs.I2CDXR = I2cDacAddr[k];
+			I2caRegs.I2CDXR = (val >> 4) | I2cDacCfg[k];	//First byte: [ PD1 | PD0 |CLR_L|LDAC_L| D7 | D6 | D5 | D4 ]
+			I2caRegs.I2CDXR = (val & 0xF) << 4;				//Second byte:[ D3 | D2 | D1 | D0 | 0 | 0 | 0 | 0 ]
+			I2caRegs.I2CCNT = 3;
+			I2caRegs.I2CMDR.all = 0x6E20;					//FREE, STT, STP, MST, TRX, IRS: start, 3 bytes, stop.
+			I2cDacBusy = 1;
+			return;
+		}
+	}
+	I2cDacBusy = 0;
+}
+
+//QueueDACFromISR(): QueueDAC() for interrupt context, where i2c_dac_isr() is already masked.
+inline void QueueDACFromISR(Uint16 k, Uint16 val)
+{
+	I2cDacVal[k] = val;
+	I2cDacPend[k] = 1;
+	if(!I2cDacBusy) StartI2cDac();
+}
+
+//QueueDAC(): Sets channel k (0-3) to val (0-255).  Replaces a value of k still waiting.
+inline void QueueDAC(Uint16 k, Uint16 val)
+{
+	I2cDacVal[k] = val;
+	I2cDacPend[k] = 1;
+	if(!I2cDacBusy)
+	{
+		DINT;											//a few cycles, keeps i2c_dac_isr() from going idle in between
+		if(!I2cDacBusy) StartI2cDac();
+		EINT;
+	}
+}
+
+//i2c_dac_isr(): I2CINT1A, one transaction finished.
+interrupt void i2c_dac_isr(void)
+{
+	Uint16 src = I2caRegs.I2CISRC.all;					//reading clears the flag
+
+	if(src == I2C_ISRC_NACK)
+	{
+		I2cDacNacks++;
+		I2caRegs.I2CMDR.bit.STP = 1;					//release the bus, SCD follows
+		I2caRegs.I2CFFTX.bit.TXFFRST = 0;				//drop the unsent bytes
+		I2caRegs.I2CFFTX.bit.TXFFRST = 1;
+	}
+	else if(src == I2C_ISRC_SCD)
+	{
+		I2cDacSent++;
+		StartI2cDac();
+	}
+	PieCtrlRegs.PIEACK.all = PIEACK_GROUP8;				//I2CINT1A is group 8.
+}
+
+#endif /*ECI_I2CDAC_H*/
@@ -0,0 +1,130 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: ECI_Load.h
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		ISR overrun detection, CPU load metering and degradation policy.
+ *
+ * 		The EPwm1 carrier position is read at ISR entry and exit.  In up-down
+ * 		mode the position in the period is TBCTR counting up and 2*PWM_PD - TBCTR
+ * 		counting down, so the ISR duration over the 2*PWM_PD TBCLK period is the
+ * 		CPU load of that period.  At exit the PIE flag of the control interrupt is
+ * 		checked.  If it is already set, the next period's interrupt came before
+ * 		this one finished, which counts as an overrun.
+ *
+ * 		The compares have a shorter deadline than the period.  They are shadow
+ * 		loaded CMP_DEADLINE counts after the trigger (ECI_API.h), 3/4 of the
+ * 		period with ADC_DMA and ADC_OVERSAMPLE = 4, so LoadCmpWritten() reads the
+ * 		position again once they are written.  IsrDeadline is the time from the
+ * 		trigger, which includes the last ADC burst and the interrupt latency,
+ * 		over CMP_DEADLINE.  Above 1 the outputs went out a period late, counted in
+ * 		IsrLate.
+ *
+ * 		If a tick overruns or is late, or its load or IsrDeadline is above
+ * 		DegradeLoad, the parts in DegradePolicy are skipped on the next tick
+ * 		instead of letting the whole schedule slip:
+ *
+ * 			DEGRADE_DEBUG	debug capture and state snapshot.
+ * 			DEGRADE_VDC		Vdc loop, irdref is held.
+ * 			DEGRADE_INV		INV voltage loops, the last outputs are only rotated.
+ *
+ * 		IsrLoad, IsrLoadMax, IsrDeadline, IsrDeadlineMax, IsrOverruns, IsrLate
+ * 		and IsrDegraded are published for the debugger and CAN.
+ *
+ * 		ex:	LoadStart();				//first in timer_isr()
+ * 			if(!(IsrSkip & DEGRADE_DEBUG)) {...}
+ * 			SetPWM_R(cmp);
+ * 			LoadCmpWritten();			//after the last compare write
+ * 			LoadEnd();					//last in timer_isr()
+ * *****************************************************************************
+ */
+
+#ifndef ECI_LOAD_H
+#define ECI_LOAD_H
+
+#define DEGRADE_DEBUG 0x0001		//Skip the debug capture.
+#define DEGRADE_VDC 0x0002			//Skip the Vdc loop, hold irdref.
+#define DEGRADE_INV 0x0004			//Skip the INV voltage loops, hold their outputs.
+
+#define DEGRADE_POLICY DEGRADE_DEBUG	//Default DegradePolicy.
+#define DEGRADE_LOAD 0.95f			//Default DegradeLoad, fraction of the PWM period or of CMP_DEADLINE.
+
+#define LOAD_PERIOD (2*PWM_PD)		//TBCLK counts per up-down PWM period.
+
+float32 IsrLoad = 0.0f;				//Last ISR duration / PWM period, > 1 on an overrun.
+float32 IsrLoadMax = 0.0f;			//Max of IsrLoad, clear from the debugger.
+float32 IsrDeadline = 0.0f;			//Trigger to compares written / CMP_DEADLINE, > 1 if they missed the load.
+float32 IsrDeadlineMax = 0.0f;		//Max of IsrDeadline, clear from the debugger.
+Uint32 IsrOverruns = 0;				//Ticks that ran into the next period.
+Uint32 IsrLate = 0;					//Ticks whose compares missed their shadow load.
+Uint32 IsrDegraded = 0;				//Ticks run with parts skipped.
+Uint16 IsrSkip = 0;					//DEGRADE_x bits skipped in this tick.
+volatile Uint16 DegradePolicy = DEGRADE_POLICY;		//DEGRADE_x bits to skip after an overrun, a late compare or high load.
+volatile float32 DegradeLoad = DEGRADE_LOAD;		//Load or IsrDeadline above which the policy is applied.
+
+Uint16 LoadEntry = 0;				//Carrier position at ISR entry.
+Uint16 LoadNextSkip = 0;			//DEGRADE_x bits for the next tick.
+
+//CarrierPos(): EPwm1 position in the up-down period, 0 to LOAD_PERIOD.
+inline Uint16 CarrierPos()
+{
+	Uint16 tb = EPwm1Regs.TBCTR;
+
+	return EPwm1Regs.TBSTS.bit.CTRDIR ? tb : LOAD_PERIOD - tb;
+}
+
+//LoadStart(): First line of the ISR.  Sets IsrSkip for this tick.
+inline void LoadStart()
+{
+	LoadEntry = CarrierPos();
+	IsrSkip = LoadNextSkip;
+	LoadNextSkip = 0;
+	if(IsrSkip) IsrDegraded++;
+}
+
+//LoadCmpWritten(): Right after the last compare write.  Measures against the shadow load and
+//	picks the next tick's skips if the compares were late or close to it.
+inline void LoadCmpWritten()
+{
+	Uint16 pos = CarrierPos();
+	Uint16 late;
+
+	pos = (pos >= CTRL_TRIGGER_POS) ? pos - CTRL_TRIGGER_POS : pos + LOAD_PERIOD - CTRL_TRIGGER_POS;	//past zero into the next period
+	if(pos >= LOAD_PERIOD) pos -= LOAD_PERIOD;					//CarrierPos() gives LOAD_PERIOD for zero counting down
+	IsrDeadline = (float32)pos*(1.0f/CMP_DEADLINE);
+	late = (pos >= CMP_DEADLINE);
+	if(ControlISRPending())
+	{
+		late = 1;
+		IsrDeadline += (float32)LOAD_PERIOD/CMP_DEADLINE;		//The next trigger came too, at least a period more.
+	}
+	if(IsrDeadline > IsrDeadlineMax) IsrDeadlineMax = IsrDeadline;
+	if(late) IsrLate++;
+	if(late || IsrDeadline > DegradeLoad) LoadNextSkip = DegradePolicy;
+}
+
+//LoadEnd(): Last line of the ISR.  Updates the load and overrun count and picks the next tick's skips.
+inline void LoadEnd()
+{
+	Uint16 exit = CarrierPos();
+	Uint16 overrun = ControlISRPending();
+
+	if(exit < LoadEntry) exit += LOAD_PERIOD;
+	IsrLoad = (float32)(exit - LoadEntry)*(1.0f/LOAD_PERIOD);
+	if(overrun)
+	{
+		IsrOverruns++;
+		IsrLoad += 1.0f;							//At least one full period, the position alone cannot tell more.
+	}
+	if(IsrLoad > IsrLoadMax) IsrLoadMax = IsrLoad;
+	if(overrun || IsrLoad > DegradeLoad) LoadNextSkip = DegradePolicy;
+}
+
+#endif /*ECI_LOAD_H*/
@@ -0,0 +1,91 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: ECI_Modulation.h
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		Modulation output stage between the voltage references and the ePWM
+ * 		compare registers.  One guarded reciprocal of Vdc is taken per ISR and all
+ * 		phase references are scaled by it (no divisions per phase).  Every duty is
+ * 		clamped before it is scaled to a compare value, so a reference outside the
+ * 		carrier can no longer wrap the Uint16 compare (e.g. at startup with Vdc
+ * 		near zero).  The phases that were clamped are returned as SAT_x bits for
+ * 		the anti-windup of the loops upstream (see UpdatePIHold() in ECI_PI.h).
+ *
+ * 		The compare values are collected in an array and written back to back by
+ * 		SetPWM_R()/SetPWM_I()/SetPWM_N() so all phases land in the same shadow
+ * 		load.
+ *
+ * 		ex:	inv_vdc = RecipVdc(Vdc);
+ * 			sat = Modulate2L(&vabcref, inv_vdc, &d, cmp);
+ * 			SetPWM_R(cmp);
+ * *****************************************************************************
+ */
+
+#ifndef ECI_MODULATION_H
+#define ECI_MODULATION_H
+
+#define VDC_MIN 20.0f				//Vdc below which the reciprocal is held at 1/VDC_MIN [V].
+
+#define SAT_A 0x0001				//Phase a duty was clamped.
+#define SAT_B 0x0002				//Phase b duty was clamped.
+#define SAT_C 0x0004				//Phase c duty was clamped.
+
+//RecipVdc(): 1/Vdc for the modulators, guarded against Vdc near zero.
+inline float32 RecipVdc(float32 Vdc)
+{
+	return 1.0f/((Vdc > VDC_MIN) ? Vdc : VDC_MIN);
+}
+
+//ClampDuty(): Clamps d to [lo, hi], sets bit in *sat if it had to.
+inline float32 ClampDuty(float32 d, float32 lo, float32 hi, Uint16 bit, Uint16 *sat)
+{
+	if(d > hi)		{d = hi; *sat |= bit;}
+	else if(d < lo)	{d = lo; *sat |= bit;}
+	return d;
+}
+
+//Modulate2L(): Two-level (B2B) modulator.  d = v/Vdc + 0.5, the [-1 1] -> [0 1] shift of
+//	0.5*(v/(Vdc/2)) + 0.5, clamped to [0 1] and scaled to PWM_PD.  Returns the SAT_x bits.
+inline Uint16 Modulate2L(const ABC3 *v, float32 inv_vdc, ABC3 *d, Uint16 cmp[3])
+{
+	Uint16 sat = 0;
+
+	d->a = ClampDuty(v->a*inv_vdc + 0.5f, 0.0f, 1.0f, SAT_A, &sat);
+	d->b = ClampDuty(v->b*inv_vdc + 0.5f, 0.0f, 1.0f, SAT_B, &sat);
+	d->c = ClampDuty(v->c*inv_vdc + 0.5f, 0.0f, 1.0f, SAT_C, &sat);
+
+	cmp[0] = (Uint16)(d->a*PWM_PD);
+	cmp[1] = (Uint16)(d->b*PWM_PD);
+	cmp[2] = (Uint16)(d->c*PWM_PD);
+	return sat;
+}
+
+//ModulateNPC(): Three-level (NPC) modulator for references d already normalized by Vdc.
+//	d is clamped to [-1 1], the upper device of each phase gets d and the lower d + 1, each
+//	clamped to [0 1] (vertical shift by -1 for PWM clamping).  cmp[] is in the order
+//	Na1, Na2, Nb1, Nb2, Nc1, Nc2.  Returns the SAT_x bits.
+inline Uint16 ModulateNPC(ABC3 *d, Uint16 cmp[6])
+{
+	Uint16 sat = 0;
+
+	d->a = ClampDuty(d->a, -1.0f, 1.0f, SAT_A, &sat);
+	d->b = ClampDuty(d->b, -1.0f, 1.0f, SAT_B, &sat);
+	d->c = ClampDuty(d->c, -1.0f, 1.0f, SAT_C, &sat);
+
+	cmp[0] = (Uint16)(((d->a > 0.0f) ? d->a : 0.0f)*PWM_PD);
+	cmp[1] = (Uint16)(((d->a < 0.0f) ? d->a + 1.0f : 1.0f)*PWM_PD);
+	cmp[2] = (Uint16)(((d->b > 0.0f) ? d->b : 0.0f)*PWM_PD);
+	cmp[3] = (Uint16)(((d->b < 0.0f) ? d->b + 1.0f : 1.0f)*PWM_PD);
+	cmp[4] = (Uint16)(((d->c > 0.0f) ? d->c : 0.0f)*PWM_PD);
+	cmp[5] = (Uint16)(((d->c < 0.0f) ? d->c + 1.0f : 1.0f)*PWM_PD);
+	return sat;
+}
+
+#endif /*ECI_MODULATION_H*/
@@ -0,0 +1,115 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: ECI_Monitor.h
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		Analog monitor mux.  Each of the four DAC outputs (AO1-AO4) is routed to
+ * 		one signal of MonSignal[], chosen by number so it can be set over CAN:
+ *
+ * 			AO = gain*signal + offset		[V], clamped to the DAC's [0 3] V
+ *
+ * 		ServiceMonitor() runs once per control ISR.  Each route is sampled and
+ * 		queued to the DAC every div ISRs, so the rate is fixed by the ISR and the
+ * 		DAC bandwidth is split between the routes in use.  div = 0 turns a route
+ * 		off.  One DAC transaction takes about 120 us at 312.5 kHz SCL, so the four
+ * 		routes together should stay below about 8 kHz of updates.
+ *
+ * 		SetMonitor() only stages a route, ServiceMonitor() takes it over before
+ * 		it samples, so a route set from an interrupt that preempts the control
+ * 		ISR (the nested eCAN receive) is never serviced half written.
+ *
+ * 		The signal table is filled by the application (MonSignal[], MonSignals).
+ *
+ * 		ex:	SetMonitor(0, MON_SIG_VDC, 0.003f, 0.0f, 20);	//AO1 = Vdc, 1 V per 333 V, 1 kHz
+ * 			ServiceMonitor();							//in timer_isr()
+ * *****************************************************************************
+ */
+
+#ifndef ECI_MONITOR_H
+#define ECI_MONITOR_H
+
+#define MON_CHANNELS DAC_CHANNELS		//AO1-AO4.
+#define MON_SIGNALS_MAX 32				//Entries in MonSignal[], 5 bits in the CAN route message of main.c.
+#define MON_AO_MAX 3.0f					//DAC full scale [V].
+
+//One AO route.
+typedef struct
+{
+	const volatile float32 *src;
+	float32 gain;						//V per unit of the signal.
+	float32 offset;						//V
+	Uint16 div;							//Update every div control ISRs, 0 = off.
+	Uint16 cnt;
+	Uint16 sig;							//Signal number, for readback.
+} MON_ROUTE;
+
+MON_ROUTE MonRoute[MON_CHANNELS];					//Routes in use, written by ServiceMonitor() only.
+volatile MON_ROUTE MonStaged[MON_CHANNELS];		//Routes from SetMonitor(), waiting for ServiceMonitor().
+volatile Uint16 MonPending[MON_CHANNELS];			//MonStaged[ch] is complete, set by SetMonitor(), cleared by ServiceMonitor().
+const volatile float32 *MonSignal[MON_SIGNALS_MAX];	//Signals that can be routed, by number.
+Uint16 MonSignals;									//Entries used in MonSignal[].
+
+//ResetMonitor(): All routes off, staged routes dropped.  Before the control ISR is enabled.
+void ResetMonitor()
+{
+	Uint16 k;
+
+	for(k = 0; k < MON_CHANNELS; k++)
+	{
+		MonRoute[k].div = 0;
+		MonPending[k] = 0;
+	}
+}
+
+//SetMonitor(): Routes signal sig to AO channel ch from the next ServiceMonitor().  From the main loop
+//	or an interrupt.  Returns 1 if ch or sig is out of range or gain/offset is NaN, 2 if the last
+//	route for ch is still waiting for the control ISR.
+Uint16 SetMonitor(Uint16 ch, Uint16 sig, float32 gain, float32 offset, Uint16 div)
+{
+	volatile MON_ROUTE *r;
+
+	if(ch >= MON_CHANNELS || sig >= MonSignals || gain != gain || offset != offset) return 1;
+	if(MonPending[ch]) return 2;
+	r = &MonStaged[ch];
+	r->src = MonSignal[sig];
+	r->gain = gain;
+	r->offset = offset;
+	r->sig = sig;
+	r->cnt = 0;
+	r->div = div;
+	MonPending[ch] = 1;							//ServiceMonitor() takes it from here
+	return 0;
+}
+
+//ServiceMonitor(): Once per control ISR.  Queues the routes that are due to the DAC.
+inline void ServiceMonitor()
+{
+	MON_ROUTE *r;
+	float32 v;
+	Uint16 k;
+
+	for(k = 0; k < MON_CHANNELS; k++)
+	{
+		r = &MonRoute[k];
+		if(MonPending[k])
+		{
+			*r = MonStaged[k];
+			MonPending[k] = 0;
+		}
+		if(r->div == 0 || ++r->cnt < r->div) continue;
+		r->cnt = 0;
+		v = *r->src*r->gain + r->offset;
+		if(v > MON_AO_MAX) v = MON_AO_MAX;
+		if(v < 0.0f) v = 0.0f;
+		QueueDACFromISR(k, (Uint16)(v*(255.0f/MON_AO_MAX)));
+	}
+}
+
+#endif /*ECI_MONITOR_H*/
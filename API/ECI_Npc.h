@@ -0,0 +1,100 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: ECI_Npc.h
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		NPC sector and zero-sequence selection, constant time through two
+ * 		tables.  The sector code is built from the comparison bits of the
+ * 		normalized references,
+ *
+ * 			code = (vra > vrb)<<2 | (vrb > vrc)<<1 | (vrc > vra),
+ *
+ * 		which gives 1..6 for the six orderings.  Code 0 only comes from a
+ * 		three-way tie (7 is not possible), and the last sector is held then.  A
+ * 		two-way tie falls in one of the two sectors it borders.
+ *
+ * 		Within a sector the zero-sequence term is vz = k - vr[phase], picked by
+ *
+ * 			sel = (deltaVnp*i[x] > 0)<<2 | (deltaVnp*i[y] > 0)<<1 | (vr[mid] > 0),
+ *
+ * 		where the mid bit only matters when both current products are positive.
+ *
+ * 		ex:	vz_npc = NpcZeroSeq(vr, i, deltaVnp, &s->sector_code);
+ * 			s->sector = NpcSector[s->sector_code].sector;
+ * *****************************************************************************
+ */
+
+#ifndef ECI_NPC_H
+#define ECI_NPC_H
+
+#define NPC_PH_A 0		//index into the reference/current arrays
+#define NPC_PH_B 1
+#define NPC_PH_C 2
+#define NPC_PH_0 3		//always 0, used by the tie rows
+
+typedef struct
+{
+	Uint16 sector;		//sector number 1..6, 0 for a tie
+	Uint16 x;			//first current checked against deltaVnp
+	Uint16 y;			//second current checked against deltaVnp
+	Uint16 mid;			//reference whose sign breaks the tie when both are positive
+} NPC_SECTOR;
+
+typedef struct
+{
+	Uint16 phase;		//vz = k - vr[phase]
+	float32 k;
+} NPC_VZ;
+
+const NPC_SECTOR NpcSector[8] =
+{
+	{0, NPC_PH_0, NPC_PH_0, NPC_PH_0},		//000 tie
+	{4, NPC_PH_A, NPC_PH_C, NPC_PH_B},		//001 c > b > a
+	{2, NPC_PH_B, NPC_PH_C, NPC_PH_A},		//010 b > a > c
+	{3, NPC_PH_B, NPC_PH_A, NPC_PH_C},		//011 b > c > a
+	{6, NPC_PH_B, NPC_PH_A, NPC_PH_C},		//100 a > c > b
+	{5, NPC_PH_B, NPC_PH_C, NPC_PH_A},		//101 c > a > b
+	{1, NPC_PH_A, NPC_PH_C, NPC_PH_B},		//110 a > b > c
+	{0, NPC_PH_0, NPC_PH_0, NPC_PH_0}		//111 not possible
+};
+
+//[code][sel], one row per code from the (phase, k) pairs for sel = 00x, 01x, 10x, 110 and 111.
+#define NPC_VZ_ROW(p00, k00, p01, k01, p10, k10, p110, k110, p111, k111) \
+	{{p00, k00}, {p00, k00}, {p01, k01}, {p01, k01}, {p10, k10}, {p10, k10}, {p110, k110}, {p111, k111}}
+const NPC_VZ NpcVz[8][8] =
+{
+	NPC_VZ_ROW(NPC_PH_0, 0.0f, NPC_PH_0, 0.0f, NPC_PH_0, 0.0f, NPC_PH_0, 0.0f, NPC_PH_0, 0.0f),			//tie
+	NPC_VZ_ROW(NPC_PH_B, 0.0f, NPC_PH_A, -1.0f, NPC_PH_C, 1.0f, NPC_PH_A, -1.0f, NPC_PH_C, 1.0f),		//sector 4
+	NPC_VZ_ROW(NPC_PH_A, 0.0f, NPC_PH_B, 1.0f, NPC_PH_C, -1.0f, NPC_PH_C, -1.0f, NPC_PH_B, 1.0f),		//sector 2
+	NPC_VZ_ROW(NPC_PH_C, 0.0f, NPC_PH_B, 1.0f, NPC_PH_A, -1.0f, NPC_PH_A, -1.0f, NPC_PH_B, 1.0f),		//sector 3
+	NPC_VZ_ROW(NPC_PH_C, 0.0f, NPC_PH_B, -1.0f, NPC_PH_A, 1.0f, NPC_PH_B, -1.0f, NPC_PH_A, 1.0f),		//sector 6
+	NPC_VZ_ROW(NPC_PH_A, 0.0f, NPC_PH_B, -1.0f, NPC_PH_C, 1.0f, NPC_PH_B, -1.0f, NPC_PH_C, 1.0f),		//sector 5
+	NPC_VZ_ROW(NPC_PH_B, 0.0f, NPC_PH_A, 1.0f, NPC_PH_C, -1.0f, NPC_PH_C, -1.0f, NPC_PH_A, 1.0f),		//sector 1
+	NPC_VZ_ROW(NPC_PH_0, 0.0f, NPC_PH_0, 0.0f, NPC_PH_0, 0.0f, NPC_PH_0, 0.0f, NPC_PH_0, 0.0f)			//not possible
+};
+
+//NpcZeroSeq(): Zero-sequence term for the normalized references vr[] and currents i[] (NPC_PH_x order,
+//	[NPC_PH_0] = 0) and the neutral point difference deltaVnp.  *code is the sector code in and out,
+//	the last one is held on a tie.
+inline float32 NpcZeroSeq(const float32 vr[4], const float32 i[4], float32 deltaVnp, Uint16 *code)
+{
+	const NPC_SECTOR *sec;
+	Uint16 c, sel;
+
+	c = ((Uint16)(vr[NPC_PH_A] > vr[NPC_PH_B]) << 2) | ((Uint16)(vr[NPC_PH_B] > vr[NPC_PH_C]) << 1) | (Uint16)(vr[NPC_PH_C] > vr[NPC_PH_A]);
+	c = (NpcSector[c].sector != 0) ? c : *code;
+	sec = &NpcSector[c];
+
+	sel = ((Uint16)(deltaVnp*i[sec->x] > 0.0f) << 2) | ((Uint16)(deltaVnp*i[sec->y] > 0.0f) << 1) | (Uint16)(vr[sec->mid] > 0.0f);
+	*code = c;
+	return NpcVz[c][sel].k - vr[NpcVz[c][sel].phase];
+}
+
+#endif /*ECI_NPC_H*/
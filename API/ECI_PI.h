@@ -0,0 +1,95 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: ECI_PI.h
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		Discrete PI controller with output clamping and back-calculation
+ * 		anti-windup.  Written in positional form,
+ *
+ * 			u[n]   = kp*e[n] + i[n]
+ * 			i[n+1] = i[n] + ki*T*e[n] + kaw*(sat(u[n]) - u[n])
+ *
+ * 		which gives the same output as the incremental form used in timer_isr()
+ * 		before, u[n] = u[n-1] + (ki*T-kp)*e[n-1] + kp*e[n], while the output is not
+ * 		clamped.  When it is, the back-calculation term bleeds the integrator
+ * 		back so it does not wind up.
+ *
+ * 		ex:	InitPI(&pi, kp, ki, T, -max, max);
+ * 			u = UpdatePI(&pi, ref - meas);
+ * 			ResetPI(&pi);				//when the converter is disabled
+ * 			u = UpdatePIHold(&pi, e, sat);	//integrator frozen while sat != 0
+ * *****************************************************************************
+ */
+
+#ifndef ECI_PI_H
+#define ECI_PI_H
+
+//PI controller state and precomputed coefficients.
+typedef struct
+{
+	float32 kp;						//Proportional gain.
+	float32 kiT;					//Integral gain times sample time.
+	float32 kaw;					//Back-calculation gain, kiT/kp (tracking time = Ti).
+	float32 min;					//Output clamp, lower.
+	float32 max;					//Output clamp, upper.
+	float32 i;						//Integrator.
+	float32 u;						//Last (clamped) output.
+} PI_CTRL;
+
+//SetGainsPI(): Precomputes the coefficients from kp, ki and the sample time.
+inline void SetGainsPI(PI_CTRL *pi, float32 kp, float32 ki, float32 T)
+{
+	pi->kp = kp;
+	pi->kiT = ki*T;
+	pi->kaw = (kp > 0.0f) ? (ki*T)/kp : 0.0f;
+}
+
+//ResetPI(): Clears the integrator and output.
+inline void ResetPI(PI_CTRL *pi)
+{
+	pi->i = 0.0f;
+	pi->u = 0.0f;
+}
+
+//InitPI(): Sets gains and output clamp and clears the state.
+inline void InitPI(PI_CTRL *pi, float32 kp, float32 ki, float32 T, float32 min, float32 max)
+{
+	SetGainsPI(pi, kp, ki, T);
+	pi->min = min;
+	pi->max = max;
+	ResetPI(pi);
+}
+
+//UpdatePI(): One controller step for error e, returns the clamped output.
+inline float32 UpdatePI(PI_CTRL *pi, float32 e)
+{
+	float32 v = pi->kp*e + pi->i;	//Unclamped output.
+	float32 u = v;
+
+	if(u > pi->max) u = pi->max;
+	if(u < pi->min) u = pi->min;
+
+	pi->i += pi->kiT*e + pi->kaw*(u - v);
+	pi->u = u;
+	return u;
+}
+
+//UpdatePIHold(): UpdatePI() with conditional integration.  While hold is set (e.g. the modulator
+//	clamped a duty downstream of this loop) the integrator is frozen and only the P term moves.
+inline float32 UpdatePIHold(PI_CTRL *pi, float32 e, Uint16 hold)
+{
+	float32 i = pi->i;
+	float32 u = UpdatePI(pi, e);
+
+	if(hold) pi->i = i;
+	return u;
+}
+
+#endif /*ECI_PI_H*/
@@ -0,0 +1,220 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: ECI_Param.h
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		Runtime parameter dictionary for gains and setpoints, with a CAN protocol.
+ *
+ * 		The application gives a table of PARAM_DEF (type, default, range), indexed
+ * 		by parameter number, and an apply function that copies a parameter set
+ * 		into the controller state.  There are two sets: the live one, last
+ * 		applied, and a staging one that takes the writes.  CommitParams() only
+ * 		raises a flag.  ParamBoundary() at the start of timer_isr() swaps the sets
+ * 		and applies the new live set before any control code runs, so the ISR
+ * 		never sees half a gain set.  The staging set then restarts as a copy of
+ * 		the live one.
+ *
+ * 		Writes are range-checked per type.  PARAM_F32 is an IEEE float, and NaN
+ * 		is rejected.  PARAM_U16 is an integer, kept in .u.  Writes are also
+ * 		refused while a commit is waiting for the ISR.
+ *
+ * 		CAN protocol (RxParam(), reply on ParamTxMbox), 8 bytes, big endian:
+ *
+ * 			request:	byte 0 PARAM_CMD_x, 2-3 index, 4-7 value (write)
+ * 			reply:		byte 0 command, 1 PARAM_OK or PARAM_ERR_x, 2-3 index,
+ * 						4-7 live value (read), staged value (write), commit count
+ * 						(commit, revert).
+ *
+ * 		ex:	InitParams(ParamDef, PARAMS, ApplyParams);
+ * 			InitParamCan(4, 0x10000020, 5, 0x10000021);
+ * 			ParamBoundary();				//start of timer_isr()
+ * *****************************************************************************
+ */
+
+#ifndef ECI_PARAM_H
+#define ECI_PARAM_H
+
+#define PARAM_MAX 32				//Parameters in a set.
+
+#define PARAM_F32 0					//float32 parameter.
+#define PARAM_U16 1					//Integer parameter, 0-65535.
+
+#define PARAM_CMD_READ 1			//Read the live value.
+#define PARAM_CMD_WRITE 2			//Write the staged value.
+#define PARAM_CMD_COMMIT 3			//Apply the staged set at the next ISR.
+#define PARAM_CMD_REVERT 4			//Drop the staged writes.
+#define PARAM_CMD_READ_STAGED 5		//Read the staged value.
+
+#define PARAM_OK 0
+#define PARAM_ERR_INDEX 1			//No such parameter.
+#define PARAM_ERR_RANGE 2			//Outside [min max], or NaN.
+#define PARAM_ERR_BUSY 3			//A commit is still waiting for the ISR.
+#define PARAM_ERR_CMD 4				//Unknown command.
+
+//One parameter value, as sent over CAN.
+typedef union
+{
+	float32 f;
+	Uint32 u;
+} PARAM_VAL;
+
+//Dictionary entry.
+typedef struct
+{
+	Uint16 type;					//PARAM_x
+	float32 def;					//Default.
+	float32 min;
+	float32 max;
+} PARAM_DEF;
+
+typedef void (*PARAM_APPLY)(const PARAM_VAL *p);
+
+PARAM_VAL ParamBuf[2][PARAM_MAX];
+Uint16 ParamLive = 0;				//ParamBuf[ParamLive] is applied, the other one is staging.
+volatile Uint16 ParamCommit = 0;	//Set to apply the staging set at the next ParamBoundary().
+Uint16 ParamCommits = 0;			//Commits applied.
+const PARAM_DEF *ParamDefs;
+Uint16 ParamCount;
+PARAM_APPLY ParamApply;
+Uint16 ParamTxMbox;
+
+//ParamLiveSet(): The applied set.
+inline const PARAM_VAL *ParamLiveSet()
+{
+	return ParamBuf[ParamLive];
+}
+
+//ParamStaging(): The set writes go to.
+inline PARAM_VAL *ParamStaging()
+{
+	return ParamBuf[ParamLive ^ 1];
+}
+
+//DefaultParams(): The defaults of def[0..n-1] into set.
+void DefaultParams(const PARAM_DEF *def, Uint16 n, PARAM_VAL *set)
+{
+	Uint16 i;
+
+	for(i = 0; i < n; i++)
+	{
+		if(def[i].type == PARAM_U16) set[i].u = (Uint32)def[i].def;
+		else set[i].f = def[i].def;
+	}
+}
+
+//CheckParam(): PARAM_OK if v is in the range of d, else PARAM_ERR_RANGE.
+Uint16 CheckParam(const PARAM_DEF *d, PARAM_VAL v)
+{
+	if(d->type == PARAM_U16)
+	{
+		if(v.u < (Uint32)d->min || v.u > (Uint32)d->max) return PARAM_ERR_RANGE;
+	}
+	else if(!(v.f >= d->min && v.f <= d->max)) return PARAM_ERR_RANGE;	//also false for NaN
+	return PARAM_OK;
+}
+
+//InitParams(): Loads the defaults of def[0..n-1] into both sets and applies them.
+void InitParams(const PARAM_DEF *def, Uint16 n, PARAM_APPLY apply)
+{
+	Uint16 i;
+
+	ParamDefs = def;
+	ParamCount = (n < PARAM_MAX) ? n : PARAM_MAX;
+	ParamApply = apply;
+	ParamLive = 0;
+	ParamCommit = 0;
+	ParamCommits = 0;
+	DefaultParams(def, ParamCount, ParamBuf[0]);
+	for(i = 0; i < ParamCount; i++) ParamBuf[1][i] = ParamBuf[0][i];
+	apply(ParamBuf[0]);
+}
+
+//WriteParam(): Stages v for parameter i.  Returns PARAM_OK or PARAM_ERR_x.
+Uint16 WriteParam(Uint16 i, PARAM_VAL v)
+{
+	if(i >= ParamCount) return PARAM_ERR_INDEX;
+	if(ParamCommit) return PARAM_ERR_BUSY;
+	if(CheckParam(&ParamDefs[i], v) != PARAM_OK) return PARAM_ERR_RANGE;
+	ParamStaging()[i] = v;
+	return PARAM_OK;
+}
+
+//CommitParams(): The staged set goes live at the next ISR.
+inline void CommitParams()
+{
+	ParamCommit = 1;
+}
+
+//RevertParams(): Drops the staged writes.
+void RevertParams()
+{
+	Uint16 i;
+
+	if(ParamCommit) return;
+	for(i = 0; i < ParamCount; i++) ParamStaging()[i] = ParamLiveSet()[i];
+}
+
+//ParamBoundary(): Start of timer_isr(), before anything can preempt it.  Applies a commit.
+inline void ParamBoundary()
+{
+	Uint16 i;
+
+	if(!ParamCommit) return;
+	ParamLive ^= 1;
+	ParamApply(ParamBuf[ParamLive]);
+	for(i = 0; i < ParamCount; i++) ParamBuf[ParamLive ^ 1][i] = ParamBuf[ParamLive][i];
+	ParamCommits++;
+	ParamCommit = 0;
+}
+
+//RxParam(): CAN handler for the parameter protocol.
+void RxParam(volatile struct MBOX *mb)
+{
+	Uint16 cmd = mb->MDL.byte.BYTE0;
+	Uint16 i = (mb->MDL.byte.BYTE2 << 8) | mb->MDL.byte.BYTE3;
+	Uint16 status = PARAM_OK;
+	PARAM_VAL v;
+
+	v.u = mb->MDH.all;
+	switch(cmd)
+	{
+	case PARAM_CMD_READ:
+	case PARAM_CMD_READ_STAGED:
+		if(i >= ParamCount) status = PARAM_ERR_INDEX;
+		else v = (cmd == PARAM_CMD_READ) ? ParamLiveSet()[i] : ParamStaging()[i];
+		break;
+	case PARAM_CMD_WRITE:
+		status = WriteParam(i, v);
+		break;
+	case PARAM_CMD_COMMIT:
+		if(ParamCommit) status = PARAM_ERR_BUSY;
+		else CommitParams();
+		v.u = ParamCommits;
+		break;
+	case PARAM_CMD_REVERT:
+		if(ParamCommit) status = PARAM_ERR_BUSY;
+		else RevertParams();
+		v.u = ParamCommits;
+		break;
+	default:
+		status = PARAM_ERR_CMD;
+	}
+	SendCanMbox(ParamTxMbox, ((Uint32)cmd << 24) | ((Uint32)status << 16) | i, v.u);
+}
+
+//InitParamCan(): Requests on mailbox rx (ID rx_id), replies from mailbox tx (ID tx_id).
+void InitParamCan(Uint16 rx, Uint32 rx_id, Uint16 tx, Uint32 tx_id)
+{
+	ParamTxMbox = tx;
+	InitCanTxMbox(tx, tx_id);
+	InitCanRxMbox(rx, rx_id, RxParam);
+}
+
+#endif /*ECI_PARAM_H*/
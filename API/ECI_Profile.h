@@ -0,0 +1,186 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: ECI_Profile.h
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		ISR stage profiler.  CPU Timer 1 free-runs down from 0xFFFFFFFF at
+ * 		SYSCLKOUT (150 MHz) and is read at the start of timer_isr() and at the end
+ * 		of each stage.  The time between marks is kept per stage in RAM:
+ *
+ * 			min, max		cycles since the profile was last cleared.
+ * 			mean			average of the last PROF_MEAN_N samples.
+ * 			hist[]			PROF_BUCKETS buckets, 2^PROF_BUCKET_SHIFT cycles wide,
+ * 							the last one also counts everything longer.  32-bit
+ * 							counts, a bucket wraps after 2.5 days at 20 kHz.
+ *
+ * 		The EPwm1 carrier position is also read at entry.  Less CTRL_TRIGGER_POS
+ * 		(ECI_API.h), the position of the event that raises the control interrupt,
+ * 		it is the latency to the first ISR instruction in TBCLK counts:
+ *
+ * 			ADC_DMA					last SOC of the period, the DMA transfer ends
+ * 									one ADC burst after it.  The latency includes
+ * 									that conversion.
+ * 			ADC_SOCA_TRIGGER		EPwm1 SOCA (ADC_SOCA_EVENT), includes the
+ * 									conversion.
+ * 			neither					EPwm1 INT at zero.
+ *
+ * 		Marks outside ProfStart()/ProfEnd() are ignored, so the stage functions
+ * 		can also run on other controller instances (host/eci_host.c) without
+ * 		touching the statistics.
+ *
+ * 		Set ProfClear = 1 from the debugger to restart the statistics.  With
+ * 		PROFILE = 0 in ECI_API.h all calls are empty inlines and the timer is left
+ * 		alone.
+ *
+ * 		ex:	ProfStart();
+ * 			...ADC reads...
+ * 			ProfMark(PROF_ADC);
+ * 			...
+ * 			ProfEnd();
+ * *****************************************************************************
+ */
+
+#ifndef ECI_PROFILE_H
+#define ECI_PROFILE_H
+
+//ISR stages, in the order they run.
+#define PROF_ADC 0					//ADC averaging and scaling of the measurements.
+#define PROF_PLL 1					//PLL angle, sin/cos and abc->dq.
+#define PROF_LOOPS 2				//Vdc and current loops, dq->abc.
+#define PROF_INV 3					//Inverter measurements, angle, voltage loops, dq->abc.
+#define PROF_MOD 4					//NPC sector, modulation and compare writes.
+#define PROF_DEBUG 5				//Debug capture.
+#define PROF_TOTAL 6				//Whole ISR, ProfStart() to ProfEnd().
+#define PROF_STAGES 7
+
+#define PROF_BUCKETS 16				//Histogram buckets per stage.
+#define PROF_BUCKET_SHIFT 9			//Bucket width 512 cycles, 16 buckets cover 8192 cycles (one 50 us period is 7500).
+#define PROF_MEAN_SHIFT 8			//Mean over PROF_MEAN_N samples.
+#define PROF_MEAN_N (1 << PROF_MEAN_SHIFT)
+
+//Statistics of one stage, in SYSCLKOUT cycles.
+typedef struct
+{
+	Uint32 min;
+	Uint32 max;
+	Uint32 mean;					//Mean of the last complete PROF_MEAN_N samples.
+	Uint32 sum;						//Running sum towards the next mean.
+	Uint16 n;						//Samples in sum.
+	Uint32 hist[PROF_BUCKETS];
+} PROF_STAGE;
+
+#if(PROFILE)
+
+PROF_STAGE ProfStage[PROF_STAGES];
+Uint16 ProfLatencyMin;				//TBCLK counts from CTRL_TRIGGER_POS to ISR entry, min.
+Uint16 ProfLatencyMax;				//TBCLK counts from CTRL_TRIGGER_POS to ISR entry, max.
+volatile Uint16 ProfClear = 1;		//Set to clear the statistics, cleared at the next ProfStart().
+Uint32 ProfT0;						//Timer at ProfStart().
+Uint32 ProfLast;					//Timer at the last mark.
+Uint16 ProfRun = 0;					//1 from ProfStart() to ProfEnd().
+
+//ClearProfile(): Restarts all statistics.
+void ClearProfile()
+{
+	Uint16 k, b;
+
+	for(k = 0; k < PROF_STAGES; k++)
+	{
+		ProfStage[k].min = 0xFFFFFFFF;
+		ProfStage[k].max = 0;
+		ProfStage[k].mean = 0;
+		ProfStage[k].sum = 0;
+		ProfStage[k].n = 0;
+		for(b = 0; b < PROF_BUCKETS; b++)
+			ProfStage[k].hist[b] = 0;
+	}
+	ProfLatencyMin = 0xFFFF;
+	ProfLatencyMax = 0;
+}
+
+//InitProfile(): CPU Timer 1 free running at SYSCLKOUT.  Call from DSP_init() under EALLOW.
+void InitProfile()
+{
+	CpuTimer1Regs.TCR.bit.TSS = 1;					//Stop.
+	CpuTimer1Regs.PRD.all = 0xFFFFFFFF;				//Full 32-bit range, wraps every 28.6 s.
+	CpuTimer1Regs.TPR.all = 0;						//No prescale.
+	CpuTimer1Regs.TPRH.all = 0;
+	CpuTimer1Regs.TCR.bit.TIE = 0;					//No interrupt.
+	CpuTimer1Regs.TCR.bit.FREE = 0;					//Stop with the CPU at a debug halt.
+	CpuTimer1Regs.TCR.bit.SOFT = 0;
+	CpuTimer1Regs.TCR.bit.TRB = 1;					//Load PRD.
+	CpuTimer1Regs.TCR.bit.TSS = 0;					//Run.
+	ClearProfile();
+}
+
+//ProfAdd(): Adds one sample of c cycles to stage k.
+inline void ProfAdd(Uint16 k, Uint32 c)
+{
+	PROF_STAGE *p = &ProfStage[k];
+	Uint32 b = c >> PROF_BUCKET_SHIFT;
+
+	if(c < p->min) p->min = c;
+	if(c > p->max) p->max = c;
+	p->hist[(b < PROF_BUCKETS) ? b : PROF_BUCKETS - 1]++;
+	p->sum += c;
+	if(++p->n == PROF_MEAN_N)
+	{
+		p->mean = p->sum >> PROF_MEAN_SHIFT;
+		p->sum = 0;
+		p->n = 0;
+	}
+}
+
+//ProfStart(): First line of the ISR, so PROF_ADC includes ClearControlISR().
+inline void ProfStart()
+{
+	Uint16 tb = CarrierPos();
+
+	ProfT0 = CpuTimer1Regs.TIM.all;
+	ProfLast = ProfT0;
+	ProfRun = 1;
+	if(ProfClear)
+	{
+		ClearProfile();
+		ProfClear = 0;
+	}
+	tb = (tb >= CTRL_TRIGGER_POS) ? tb - CTRL_TRIGGER_POS : tb + LOAD_PERIOD - CTRL_TRIGGER_POS;	//past zero into the next period
+	if(tb < ProfLatencyMin) ProfLatencyMin = tb;
+	if(tb > ProfLatencyMax) ProfLatencyMax = tb;
+}
+
+//ProfMark(): End of stage k, the time since the last mark is added to it.
+inline void ProfMark(Uint16 k)
+{
+	Uint32 now;
+
+	if(!ProfRun) return;
+	now = CpuTimer1Regs.TIM.all;
+	ProfAdd(k, ProfLast - now);						//Down counter, wraps correctly in unsigned math.
+	ProfLast = now;
+}
+
+//ProfEnd(): Last line of the ISR, adds the whole ISR to PROF_TOTAL.
+inline void ProfEnd()
+{
+	ProfAdd(PROF_TOTAL, ProfT0 - CpuTimer1Regs.TIM.all);
+	ProfRun = 0;
+}
+
+#else
+
+inline void InitProfile()		{}
+inline void ProfStart()			{}
+inline void ProfMark(Uint16 k)	{}
+inline void ProfEnd()			{}
+
+#endif /*PROFILE*/
+
+#endif /*ECI_PROFILE_H*/
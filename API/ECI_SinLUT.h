@@ -0,0 +1,289 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: ECI_SinLUT.h
+ *
+ * Generated by host/gen_sinlut.c ('make -C host sinlut SIN_LUT_BITS=10').
+ * Do not edit, regenerate instead.
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		First quarter of a 1024 point sine wave, sin(i*pi/2/256) for
+ * 		i = 0..257.  The last two points run past 90 deg for interpolation.
+ * 		Read through SinPhase() in ECI_Trig.h.  Being const, the table is in
+ * 		.econst, which is copied from flash to RAML5 at boot.
+ * *****************************************************************************
+ */
+
+#ifndef ECI_SINLUT_H
+#define ECI_SINLUT_H
+
+#define SIN_LUT_BITS 10				//log2 of the full-wave length.
+#define SIN_LUT_QUARTER 256			//Points per quarter wave.
+
+const float32 SinLUT[SIN_LUT_QUARTER + 2] =
+{
+	0.000000000e+00f,
+	6.135884672e-03f,
+	1.227153838e-02f,
+	1.840673015e-02f,
+	2.454122901e-02f,
+	3.067480400e-02f,
+	3.680722415e-02f,
+	4.293825850e-02f,
+	4.906767607e-02f,
+	5.519524589e-02f,
+	6.132073700e-02f,
+	6.744392216e-02f,
+	7.356456667e-02f,
+	7.968243957e-02f,
+	8.579730988e-02f,
+	9.190895408e-02f,
+	9.801714122e-02f,
+	1.041216329e-01f,
+	1.102222055e-01f,
+	1.163186282e-01f,
+	1.224106774e-01f,
+	1.284981072e-01f,
+	1.345807016e-01f,
+	1.406582445e-01f,
+	1.467304677e-01f,
+	1.527971923e-01f,
+	1.588581502e-01f,
+	1.649131179e-01f,
+	1.709618866e-01f,
+	1.770042181e-01f,
+	1.830398887e-01f,
+	1.890686601e-01f,
+	1.950903237e-01f,
+	2.011046410e-01f,
+	2.071113735e-01f,
+	2.131103128e-01f,
+	2.191012353e-01f,
+	2.250839174e-01f,
+	2.310581058e-01f,
+	2.370236069e-01f,
+	2.429801822e-01f,
+	2.489276081e-01f,
+	2.548656464e-01f,
+	2.607941031e-01f,
+	2.667127550e-01f,
+	2.726213634e-01f,
+	2.785196900e-01f,
+	2.844075263e-01f,
+	2.902846634e-01f,
+	2.961508930e-01f,
+	3.020059466e-01f,
+	3.078496456e-01f,
+	3.136817515e-01f,
+	3.195020258e-01f,
+	3.253102899e-01f,
+	3.311063051e-01f,
+	3.368898630e-01f,
+	3.426607251e-01f,
+	3.484186828e-01f,
+	3.541635275e-01f,
+	3.598950505e-01f,
+	3.656129837e-01f,
+	3.713172078e-01f,
+	3.770074248e-01f,
+	3.826834261e-01f,
+	3.883450329e-01f,
+	3.939920366e-01f,
+	3.996241987e-01f,
+	4.052413106e-01f,
+	4.108431637e-01f,
+	4.164295495e-01f,
+	4.220002592e-01f,
+	4.275550842e-01f,
+	4.330938160e-01f,
+	4.386162460e-01f,
+	4.441221356e-01f,
+	4.496113360e-01f,
+	4.550835788e-01f,
+	4.605387151e-01f,
+	4.659765065e-01f,
+	4.713967443e-01f,
+	4.767992198e-01f,
+	4.821837842e-01f,
+	4.875501692e-01f,
+	4.928981960e-01f,
+	4.982276559e-01f,
+	5.035383701e-01f,
+	5.088301301e-01f,
+	5.141027570e-01f,
+	5.193560123e-01f,
+	5.245896578e-01f,
+	5.298036337e-01f,
+	5.349976420e-01f,
+	5.401714444e-01f,
+	5.453249812e-01f,
+	5.504579544e-01f,
+	5.555702448e-01f,
+	5.606615543e-01f,
+	5.657318234e-01f,
+	5.707807541e-01f,
+	5.758081675e-01f,
+	5.808139443e-01f,
+	5.857978463e-01f,
+	5.907596946e-01f,
+	5.956993103e-01f,
+	6.006164551e-01f,
+	6.055110693e-01f,
+	6.103827953e-01f,
+	6.152315736e-01f,
+	6.200572252e-01f,
+	6.248595119e-01f,
+	6.296382546e-01f,
+	6.343932748e-01f,
+	6.391244531e-01f,
+	6.438315511e-01f,
+	6.485143900e-01f,
+	6.531728506e-01f,
+	6.578066945e-01f,
+	6.624158025e-01f,
+	6.669999361e-01f,
+	6.715589762e-01f,
+	6.760926843e-01f,
+	6.806010008e-01f,
+	6.850836873e-01f,
+	6.895405650e-01f,
+	6.939714551e-01f,
+	6.983762383e-01f,
+	7.027547359e-01f,
+	7.071067691e-01f,
+	7.114322186e-01f,
+	7.157308459e-01f,
+	7.200025320e-01f,
+	7.242470980e-01f,
+	7.284643650e-01f,
+	7.326542735e-01f,
+	7.368165851e-01f,
+	7.409511209e-01f,
+	7.450577617e-01f,
+	7.491363883e-01f,
+	7.531868219e-01f,
+	7.572088242e-01f,
+	7.612023950e-01f,
+	7.651672363e-01f,
+	7.691033483e-01f,
+	7.730104327e-01f,
+	7.768884897e-01f,
+	7.807372212e-01f,
+	7.845565677e-01f,
+	7.883464098e-01f,
+	7.921065688e-01f,
+	7.958369255e-01f,
+	7.995372415e-01f,
+	8.032075167e-01f,
+	8.068475723e-01f,
+	8.104571700e-01f,
+	8.140363097e-01f,
+	8.175848126e-01f,
+	8.211025000e-01f,
+	8.245893121e-01f,
+	8.280450702e-01f,
+	8.314695954e-01f,
+	8.348628879e-01f,
+	8.382247090e-01f,
+	8.415549994e-01f,
+	8.448535800e-01f,
+	8.481203318e-01f,
+	8.513551950e-01f,
+	8.545579910e-01f,
+	8.577286005e-01f,
+	8.608669639e-01f,
+	8.639728427e-01f,
+	8.670462370e-01f,
+	8.700869679e-01f,
+	8.730949759e-01f,
+	8.760700822e-01f,
+	8.790122271e-01f,
+	8.819212914e-01f,
+	8.847970963e-01f,
+	8.876396418e-01f,
+	8.904487491e-01f,
+	8.932242990e-01f,
+	8.959662318e-01f,
+	8.986744881e-01f,
+	9.013488293e-01f,
+	9.039893150e-01f,
+	9.065957069e-01f,
+	9.091680050e-01f,
+	9.117060304e-01f,
+	9.142097831e-01f,
+	9.166790843e-01f,
+	9.191138744e-01f,
+	9.215140343e-01f,
+	9.238795042e-01f,
+	9.262102246e-01f,
+	9.285060763e-01f,
+	9.307669401e-01f,
+	9.329928160e-01f,
+	9.351835251e-01f,
+	9.373390079e-01f,
+	9.394592047e-01f,
+	9.415440559e-01f,
+	9.435934424e-01f,
+	9.456073046e-01f,
+	9.475855827e-01f,
+	9.495281577e-01f,
+	9.514350295e-01f,
+	9.533060193e-01f,
+	9.551411867e-01f,
+	9.569403529e-01f,
+	9.587034583e-01f,
+	9.604305029e-01f,
+	9.621214271e-01f,
+	9.637760520e-01f,
+	9.653944373e-01f,
+	9.669764638e-01f,
+	9.685220718e-01f,
+	9.700312614e-01f,
+	9.715039134e-01f,
+	9.729399681e-01f,
+	9.743393660e-01f,
+	9.757021070e-01f,
+	9.770281315e-01f,
+	9.783173800e-01f,
+	9.795697927e-01f,
+	9.807852507e-01f,
+	9.819638729e-01f,
+	9.831054807e-01f,
+	9.842100739e-01f,
+	9.852776527e-01f,
+	9.863080978e-01f,
+	9.873014092e-01f,
+	9.882575870e-01f,
+	9.891765118e-01f,
+	9.900581837e-01f,
+	9.909026623e-01f,
+	9.917097688e-01f,
+	9.924795628e-01f,
+	9.932119250e-01f,
+	9.939069748e-01f,
+	9.945645928e-01f,
+	9.951847196e-01f,
+	9.957674146e-01f,
+	9.963126183e-01f,
+	9.968202710e-01f,
+	9.972904325e-01f,
+	9.977230430e-01f,
+	9.981181026e-01f,
+	9.984755516e-01f,
+	9.987954497e-01f,
+	9.990777373e-01f,
+	9.993223548e-01f,
+	9.995294213e-01f,
+	9.996988177e-01f,
+	9.998306036e-01f,
+	9.999247193e-01f,
+	9.999811649e-01f,
+	1.000000000e+00f,
+	9.999811649e-01f
+};
+
+#endif /*ECI_SINLUT_H*/
@@ -0,0 +1,209 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: ECI_Trace.h
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		Triggered trace recorder for the ISR.  Up to TRACE_CH_MAX channels, each
+ * 		a pointer into the controller state, are stored as one frame per
+ * 		TraceCfg.decim calls of TraceSample() in a circular buffer of TRACE_WORDS
+ * 		16-bit words (all of RAML7, section "tracebuf").  Frames are float32, or
+ * 		int16 with TraceCfg.packed = 1 (x*scale, saturated by the FPU
+ * 		conversion), which doubles the history.
+ *
+ * 		States:
+ * 			TRACE_OFF		disarmed, TraceSample() costs one compare.
+ * 			TRACE_ARMED		recording, the trigger is checked once TraceCfg.pre
+ * 							frames are in.
+ * 			TRACE_POST		triggered, recording the rest of the buffer.
+ * 			TRACE_DONE		frozen (TraceCfg.freeze = 1).  With freeze = 0 the
+ * 							recorder arms again and keeps rolling, TraceTrigPos
+ * 							marks the last trigger.
+ *
+ * 		Triggers (TraceCfg.trig) on *trig_src against level: TRIG_ABOVE,
+ * 		TRIG_BELOW, TRIG_RISE, TRIG_FALL, or TRIG_FAULT on *fault_src & fault_mask.
+ * 		TRIG_NONE never triggers and rolls like the old vabuff[] arrays.
+ * 		TraceArm() falls back to TRIG_NONE when the trigger has no source.
+ *
+ * 		Change TraceCfg from the debugger and set TraceArmReq = 1.  TraceArm()
+ * 		runs from the main loop.  Once the trace is TRACE_DONE, TraceRead(f, k)
+ * 		returns channel k of frame f, counted from the oldest frame, and the
+ * 		trigger frame is f = TraceCfg.pre.
+ *
+ * 		ex:	SetTraceCh(0, &Ctrl.afe.Vdc, 16.0f);
+ * 			TraceCfg.nch = 1;
+ * 			TraceArm();
+ * 			...
+ * 			TraceSample();					//in timer_isr()
+ * *****************************************************************************
+ */
+
+#ifndef ECI_TRACE_H
+#define ECI_TRACE_H
+
+#define TRACE_WORDS 4096			//16-bit words of trace buffer (RAML7).
+#define TRACE_CH_MAX 8				//Channels per frame.
+
+#define TRACE_OFF 0					//Disarmed.
+#define TRACE_DONE 1				//Frozen after the post-trigger frames.
+#define TRACE_ARMED 2				//Recording, waiting for the trigger.
+#define TRACE_POST 3				//Recording after the trigger.
+
+#define TRIG_NONE 0					//Never triggers.
+#define TRIG_ABOVE 1				//*trig_src > level
+#define TRIG_BELOW 2				//*trig_src < level
+#define TRIG_RISE 3					//*trig_src crosses level going up.
+#define TRIG_FALL 4					//*trig_src crosses level going down.
+#define TRIG_FAULT 5				//*fault_src & fault_mask nonzero.
+
+//One trace channel.
+typedef struct
+{
+	const volatile float32 *src;
+	float32 scale;					//int16 counts per unit when packed, 1/scale when read back.
+} TRACE_CH;
+
+//Trace configuration, read by TraceArm().
+typedef struct
+{
+	TRACE_CH ch[TRACE_CH_MAX];
+	Uint16 nch;						//Channels in use, 1 to TRACE_CH_MAX.
+	Uint16 decim;					//Record one frame every decim calls.
+	Uint16 packed;					//1: int16 frames, 0: float32 frames.
+	Uint16 freeze;					//1: stop at TRACE_DONE, 0: arm again and keep rolling.
+	Uint16 pre;						//Frames kept before the trigger.
+	Uint16 trig;					//TRIG_x
+	const volatile float32 *trig_src;
+	float32 level;
+	const volatile Uint16 *fault_src;
+	Uint16 fault_mask;
+} TRACE_CFG;
+
+//Trace storage, frames of nch values back to back.
+typedef union
+{
+	float32 f[TRACE_WORDS/2];
+	int16 q[TRACE_WORDS];
+} TRACE_BUF;
+
+#pragma DATA_SECTION(TraceBuf, "tracebuf")
+TRACE_BUF TraceBuf;
+TRACE_CFG TraceCfg;
+volatile Uint16 TraceArmReq;		//Set from the debugger to run TraceArm() from the main loop.
+volatile Uint16 TraceState;			//TRACE_x
+Uint16 TraceFrames;					//Frames in the buffer.
+Uint16 TraceLen;					//Values in the buffer, TraceFrames*nch.
+Uint16 TracePos;					//Next value written, the oldest frame once the buffer is full.
+Uint16 TraceTrigPos;				//First value of the trigger frame.
+Uint16 TraceCount;					//Frames left before the trigger is checked / before TRACE_DONE.
+Uint16 TraceDecimCnt;
+float32 TracePrev;					//Last trigger sample, for the edges.
+
+//SetTraceCh(): Sets channel k to record *src, scaled by scale when packed.
+inline void SetTraceCh(Uint16 k, const volatile float32 *src, float32 scale)
+{
+	TraceCfg.ch[k].src = src;
+	TraceCfg.ch[k].scale = scale;
+}
+
+//TraceArm(): Sizes the buffer for TraceCfg and starts recording.  Not from the ISR.
+void TraceArm()
+{
+	TRACE_CFG *c = &TraceCfg;
+
+	TraceState = TRACE_OFF;								//ISR keeps out while the buffer is resized.
+	TraceArmReq = 0;
+	if(c->nch < 1) c->nch = 1;
+	if(c->nch > TRACE_CH_MAX) c->nch = TRACE_CH_MAX;
+	if(c->decim < 1) c->decim = 1;
+	if((c->trig == TRIG_FAULT) ? c->fault_src == 0 : c->trig_src == 0) c->trig = TRIG_NONE;	//no source, the ISR would read address 0
+	TraceFrames = (c->packed ? TRACE_WORDS : TRACE_WORDS/2)/c->nch;
+	if(c->pre >= TraceFrames) c->pre = TraceFrames - 1;
+	TraceLen = TraceFrames*c->nch;
+	TracePos = 0;
+	TraceTrigPos = 0;
+	TraceCount = c->pre;
+	TraceDecimCnt = 0;
+	TracePrev = c->trig_src ? *c->trig_src : 0.0f;
+	TraceState = TRACE_ARMED;
+}
+
+//TraceTriggered(): 1 if the trigger condition holds for this frame.
+inline Uint16 TraceTriggered()
+{
+	const TRACE_CFG *c = &TraceCfg;
+	float32 x, prev;
+
+	if(c->trig == TRIG_FAULT) return (*c->fault_src & c->fault_mask) != 0;
+	if(c->trig == TRIG_NONE) return 0;
+	x = *c->trig_src;
+	prev = TracePrev;
+	TracePrev = x;
+	switch(c->trig)
+	{
+	case TRIG_ABOVE:	return x > c->level;
+	case TRIG_BELOW:	return x < c->level;
+	case TRIG_RISE:		return prev <= c->level && x > c->level;
+	case TRIG_FALL:		return prev >= c->level && x < c->level;
+	}
+	return 0;
+}
+
+//TraceSample(): Records one frame every decim calls.  Call once per ISR.
+inline void TraceSample()
+{
+	const TRACE_CFG *c = &TraceCfg;
+	Uint16 p, k;
+
+	if(TraceState < TRACE_ARMED) return;
+	if(++TraceDecimCnt < c->decim) return;
+	TraceDecimCnt = 0;
+
+	p = TracePos;
+	if(c->packed)
+		for(k = 0; k < c->nch; k++) TraceBuf.q[p + k] = (int16)(*c->ch[k].src*c->ch[k].scale);
+	else
+		for(k = 0; k < c->nch; k++) TraceBuf.f[p + k] = *c->ch[k].src;
+	TracePos = (p + c->nch < TraceLen) ? p + c->nch : 0;
+
+	if(TraceState == TRACE_ARMED)
+	{
+		Uint16 trig = TraceTriggered();					//also keeps TracePrev current during the pre-trigger fill
+
+		if(TraceCount)
+		{
+			TraceCount--;
+			return;
+		}
+		if(!trig) return;
+		TraceTrigPos = p;
+		TraceCount = TraceFrames - c->pre;				//post-trigger frames, this one included
+		TraceState = TRACE_POST;
+	}
+	if(--TraceCount == 0)
+	{
+		if(c->freeze) TraceState = TRACE_DONE;
+		else
+		{
+			TraceCount = c->pre;						//holdoff before the next trigger
+			TraceState = TRACE_ARMED;
+		}
+	}
+}
+
+//TraceRead(): Channel k of frame f, f = 0 is the oldest frame.  Valid at TRACE_DONE.
+float32 TraceRead(Uint16 f, Uint16 k)
+{
+	Uint32 i = TracePos + (Uint32)f*TraceCfg.nch + k;
+
+	if(i >= TraceLen) i -= TraceLen;
+	return TraceCfg.packed ? TraceBuf.q[i]/TraceCfg.ch[k].scale : TraceBuf.f[i];
+}
+
+#endif /*ECI_TRACE_H*/
@@ -0,0 +1,94 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: ECI_Transform.h
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		Fused Clarke/Park transforms for several abc vectors that share one
+ * 		angle.  Each vector is taken to alpha/beta once and then rotated by the
+ * 		cached sin/cos pair, which replaces the three cos/sin products per axis
+ * 		of the direct abc->dq form:
+ *
+ * 			alpha = 2/3*a - 1/3*(b + c)			d = alpha*cos + beta*sin
+ * 			beta  = 1/sqrt(3)*(b - c)			q = beta*cos - alpha*sin
+ *
+ * 		This is the same amplitude-invariant transform as
+ * 		d = 2/3*(a*cos(th) + b*cos(th-120) + c*cos(th+120)).  The inverse rotates
+ * 		back to alpha/beta and splits into abc with the +/-120 deg coefficients.
+ *
+ * 		The loop bodies are straight-line with independent products, and n is a
+ * 		constant at every call.  With the inlined loops unrolled, cl2000
+ * 		(--float_support=fpu32 -O2) pairs the MPYF32/ADDF32 with the MOV32 loads
+ * 		(parallel || instructions) without hand-written assembly.
+ *
+ * 		ex:	ClarkePark(&sc_vin, abc, dq, 2);		//voltage and current, one angle
+ * 			ClarkeParkInv(&sc_vin, &vref, &vabcref, 1);
+ * *****************************************************************************
+ */
+
+#ifndef ECI_TRANSFORM_H
+#define ECI_TRANSFORM_H
+
+#define ONE_THIRD 0.333333333f		//1/3
+#define TWO_THIRDS 0.666666667f		//2/3
+#define INV_SQRT3 0.577350269f		//1/sqrt(3)
+
+//Three-phase quantity.
+typedef struct
+{
+	float32 a;
+	float32 b;
+	float32 c;
+} ABC3;
+
+//Rotating frame quantity.
+typedef struct
+{
+	float32 d;
+	float32 q;
+} DQ2;
+
+//ClarkePark(): abc->dq of n vectors at the angle cached in sc.
+inline void ClarkePark(const SINCOS3 *sc, const ABC3 *abc, DQ2 *dq, Uint16 n)
+{
+	float32 c = sc->cos_a;
+	float32 s = sc->sin_a;
+	Uint16 k;
+
+	for(k = 0; k < n; k++)
+	{
+		float32 alpha = TWO_THIRDS*abc[k].a - ONE_THIRD*(abc[k].b + abc[k].c);
+		float32 beta = INV_SQRT3*(abc[k].b - abc[k].c);
+
+		dq[k].d = alpha*c + beta*s;
+		dq[k].q = beta*c - alpha*s;
+	}
+}
+
+//ClarkeParkInv(): dq->abc of n vectors at the angle cached in sc.
+inline void ClarkeParkInv(const SINCOS3 *sc, const DQ2 *dq, ABC3 *abc, Uint16 n)
+{
+	float32 c = sc->cos_a;
+	float32 s = sc->sin_a;
+	Uint16 k;
+
+	for(k = 0; k < n; k++)
+	{
+		float32 alpha = dq[k].d*c - dq[k].q*s;
+		float32 beta = dq[k].d*s + dq[k].q*c;
+		float32 h = COS_120*alpha;
+		float32 r = SIN_120*beta;
+
+		abc[k].a = alpha;
+		abc[k].b = h + r;
+		abc[k].c = h - r;
+	}
+}
+
+#endif /*ECI_TRANSFORM_H*/
@@ -0,0 +1,157 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: ECI_Trig.h
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		Sin/cos cache for the three-phase transforms in timer_isr().  Only one
+ * 		sin/cos pair is evaluated per angle per ISR, the +/-120 deg terms are
+ * 		found by rotating that pair with constant coefficients:
+ *
+ * 			cos(th -/+ 120) = -0.5*cos(th) +/- 0.866025*sin(th)
+ * 			sin(th -/+ 120) = -0.5*sin(th) -/+ 0.866025*cos(th)
+ *
+ * 		The PLL, the abc->dq transforms and the dq->abc inverse transforms all
+ * 		read the same cached result.
+ *
+ * 		Angles are kept as 32-bit phase accumulators (PHASE32), 2^32 counts per
+ * 		turn.  Adding the per-sample step wraps at 2*pi for free in both
+ * 		directions and repeats exactly, with no compare/subtract.
+ *
+ * 		With TRIG_LUT = 1 the pair comes from the generated quarter-wave table in
+ * 		ECI_SinLUT.h (make -C host sinlut).  The phase's top 2 bits select the
+ * 		quadrant, the next SIN_LUT_BITS-2 bits the table point, and the rest
+ * 		interpolate linearly to the next point.  For the default 1024 point wave
+ * 		the error is under 5e-6.
+ *
+ * 		ex:	phase_vin += PhaseStep(omega_pll, T);
+ * 			UpdateSinCos3Phase(&sc_vin, phase_vin);
+ * 			vrd = 0.666667*(va*sc_vin.cos_a + vb*sc_vin.cos_b + vc*sc_vin.cos_c);
+ * *****************************************************************************
+ */
+
+#ifndef ECI_TRIG_H
+#define ECI_TRIG_H
+
+#include <math.h>
+#include <ECI_SinLUT.h>
+
+#ifndef FLOAT32_MATH
+	#define FLOAT32_MATH 1
+#endif
+
+//With FLOAT32_MATH the single-precision libm entry points are used so that no
+//argument or result of the control path is promoted to double.
+#if(FLOAT32_MATH)
+	#define COS_F32(x) cosf(x)
+	#define SIN_F32(x) sinf(x)
+#else
+	#define COS_F32(x) ((float32)cos(x))
+	#define SIN_F32(x) ((float32)sin(x))
+#endif
+
+#ifndef TRIG_LUT
+	#define TRIG_LUT 1
+#endif
+
+#define COS_120 -0.5f				//cos(120 deg)
+#define SIN_120 0.8660254f			//sin(120 deg)
+
+typedef Uint32 PHASE32;				//Phase accumulator angle, 2^32 counts = 2*pi.
+#define PHASE_PER_RAD 683565275.6f	//2^32/(2*pi)
+#define RAD_PER_PHASE 1.462918e-9f	//2*pi/2^32
+#define PHASE_90 0x40000000UL		//90 deg, cos(x) = sin(x + 90 deg).
+#define PHASE_180 0x80000000UL		//180 deg, sin(x + 180 deg) = -sin(x).
+
+#define SIN_LUT_SHIFT (32 - SIN_LUT_BITS)				//Phase bits below the table index.
+#define SIN_LUT_FRAC ((1UL << SIN_LUT_SHIFT) - 1)		//Mask of the interpolation fraction.
+
+//Cached sin/cos of one angle and its +/-120 deg shifted copies.
+typedef struct
+{
+	float32 theta;					//Angle the cache was evaluated at [rad].
+	float32 cos_a;					//cos(theta)
+	float32 sin_a;					//sin(theta)
+	float32 cos_b;					//cos(theta - 120 deg)
+	float32 sin_b;					//sin(theta - 120 deg)
+	float32 cos_c;					//cos(theta + 120 deg)
+	float32 sin_c;					//sin(theta + 120 deg)
+} SINCOS3;
+
+//UpdateSinCos3(): Evaluates one sin/cos pair at theta and rotates it by +/-120 deg.
+inline void UpdateSinCos3(SINCOS3 *sc, float32 theta)
+{
+	float32 c = COS_F32(theta);
+	float32 s = SIN_F32(theta);
+	float32 hc = COS_120*c;
+	float32 hs = COS_120*s;
+	float32 rc = SIN_120*c;
+	float32 rs = SIN_120*s;
+
+	sc->theta = theta;
+	sc->cos_a = c;
+	sc->sin_a = s;
+	sc->cos_b = hc + rs;			//cos(th-120) = cos*cos120 + sin*sin120
+	sc->sin_b = hs - rc;			//sin(th-120) = sin*cos120 - cos*sin120
+	sc->cos_c = hc - rs;			//cos(th+120) = cos*cos120 - sin*sin120
+	sc->sin_c = hs + rc;			//sin(th+120) = sin*cos120 + cos*sin120
+}
+
+//PhaseStep(): Phase increment per sample for frequency omega [rad/s] and sample time T [s].
+//	|omega*T| must be below pi, i.e. any frequency under half the sample rate.
+inline PHASE32 PhaseStep(float32 omega, float32 T)
+{
+	return (PHASE32)(int32)(omega*T*PHASE_PER_RAD);
+}
+
+//PhaseToRad(): Phase as an angle in [-pi, pi) [rad].
+inline float32 PhaseToRad(PHASE32 phase)
+{
+	return (float32)(int32)phase*RAD_PER_PHASE;
+}
+
+//SinPhase(): sin of a phase from the quarter-wave table, linearly interpolated.
+inline float32 SinPhase(PHASE32 phase)
+{
+	Uint32 r = phase & (PHASE_90 - 1);			//Angle within the quadrant.
+	Uint16 i;
+	float32 f, y;
+
+	if(phase & PHASE_90) r = PHASE_90 - r;		//2nd and 4th quadrants run the table backwards.
+	i = (Uint16)(r >> SIN_LUT_SHIFT);
+	f = (float32)(r & SIN_LUT_FRAC)*(1.0f/(SIN_LUT_FRAC + 1));
+	y = SinLUT[i] + (SinLUT[i + 1] - SinLUT[i])*f;
+	return (phase & PHASE_180) ? -y : y;		//3rd and 4th quadrants are negative.
+}
+
+//UpdateSinCos3Phase(): UpdateSinCos3() for a phase accumulator angle.  With TRIG_LUT the pair is
+//	read from SinLUT[], else from sinf/cosf.
+inline void UpdateSinCos3Phase(SINCOS3 *sc, PHASE32 phase)
+{
+#if(TRIG_LUT)
+	float32 c = SinPhase(phase + PHASE_90);
+	float32 s = SinPhase(phase);
+	float32 hc = COS_120*c;
+	float32 hs = COS_120*s;
+	float32 rc = SIN_120*c;
+	float32 rs = SIN_120*s;
+
+	sc->theta = PhaseToRad(phase);
+	sc->cos_a = c;
+	sc->sin_a = s;
+	sc->cos_b = hc + rs;
+	sc->sin_b = hs - rc;
+	sc->cos_c = hc - rs;
+	sc->sin_c = hs + rc;
+#else
+	UpdateSinCos3(sc, PhaseToRad(phase));
+#endif
+}
+
+#endif /*ECI_TRIG_H*/
@@ -1,208 +0,0 @@
-/* DSP Controller Project
- * Energy Conversion and Integration Group
- * Center for Advanced Power Systems
- * Florida State University
- * ******************************************************************************
- * 
- * Filename: lut_def.c
- * 
- * Last Modified: September 1, 2011
- * 	
- * Author: Troy Bevis
- * 
- * 
- * 
- * ******************************************************************************
- * Purpose:
- * 		This file defines a 60 Hz sine wave lookup tabe.  It has 168 samples and
- * 		is meant to run at a sample rate of 10,080 Hz. 
- * 		
- * 		The 3-phase offsets are the following:
- * 			Phase A (0 deg) = 0;
- * 			Phase B (-120 deg) = 112;
- * 			Phase C (+120 deg) = 56; 
- * 	
- * 		Use the offsets in addition with %168 to obtain the +/-120 deg phase
- * 		differences for 3-phase phase shifts.
- * 	
- * 		ex: Phase B index =>  B = LUT[(i + 112)%168];
- * 		where i is the current sample of Phase A.
- * *****************************************************************************
- */
-
-#ifndef LUT_DEF_H_
-#define LUT_DEF_H_
-
-const float32 LUT[]  =
-{
-	0.0,
-    0.0374,
-    0.0747,
-    0.1120,
-    0.1490,
-    0.1859,
-    0.2225,
-    0.2588,
-    0.2948,
-    0.3303,
-    0.3653,
-    0.3999,
-    0.4339,
-    0.4673,
-    0.5000,
-    0.5320,
-    0.5633,
-    0.5938,
-    0.6235,
-    0.6523,
-    0.6802,
-    0.7071,
-    0.7331,
-    0.7580,
-    0.7818,
-    0.8046,
-    0.8262,
-    0.8467,
-    0.8660,
-    0.8841,
-    0.9010,
-    0.9166,
-    0.9309,
-    0.9439,
-    0.9556,
-    0.9659,
-    0.9749,
-    0.9826,
-    0.9888,
-    0.9937,
-    0.9972,
-    0.9993,
-    1.0000,
-    0.9993,
-    0.9972,
-    0.9937,
-    0.9888,
-    0.9826,
-    0.9749,
-    0.9659,
-    0.9556,
-    0.9439,
-    0.9309,
-    0.9166,
-    0.9010,
-    0.8841,
-    0.8660,
-    0.8467,
-    0.8262,
-    0.8046,
-    0.7818,
-    0.7580,
-    0.7331,
-    0.7071,
-    0.6802,
-    0.6523,
-    0.6235,
-    0.5938,
-    0.5633,
-    0.5320,
-    0.5000,
-    0.4673,
-    0.4339,
-    0.3999,
-    0.3653,
-    0.3303,
-    0.2948,
-    0.2588,
-    0.2225,
-    0.1859,
-    0.1490,
-    0.1120,
-    0.0747,
-    0.0374,
-    0.0000,
-   -0.0374,
-   -0.0747,
-   -0.1120,
-   -0.1490,
-   -0.1859,
-   -0.2225,
-   -0.2588,
-   -0.2948,
-   -0.3303,
-   -0.3653,
-   -0.3999,
-   -0.4339,
-   -0.4673,
-   -0.5000,
-   -0.5320,
-   -0.5633,
-   -0.5938,
-   -0.6235,
-   -0.6523,
-   -0.6802,
-   -0.7071,
-   -0.7331,
-   -0.7580,
-   -0.7818,
-   -0.8046,
-   -0.8262,
-   -0.8467,
-   -0.8660,
-   -0.8841,
-   -0.9010,
-   -0.9166,
-   -0.9309,
-   -0.9439,
-   -0.9556,
-   -0.9659,
-   -0.9749,
-   -0.9826,
-   -0.9888,
-   -0.9937,
-   -0.9972,
-   -0.9993,
-   -1.0000,
-   -0.9993,
-   -0.9972,
-   -0.9937,
-   -0.9888,
-   -0.9826,
-   -0.9749,
-   -0.9659,
-   -0.9556,
-   -0.9439,
-   -0.9309,
-   -0.9166,
-   -0.9010,
-   -0.8841,
-   -0.8660,
-   -0.8467,
-   -0.8262,
-   -0.8046,
-   -0.7818,
-   -0.7580,
-   -0.7331,
-   -0.7071,
-   -0.6802,
-   -0.6523,
-   -0.6235,
-   -0.5938,
-   -0.5633,
-   -0.5320,
-   -0.5000,
-   -0.4673,
-   -0.4339,
-   -0.3999,
-   -0.3653,
-   -0.3303,
-   -0.2948,
-   -0.2588,
-   -0.2225,
-   -0.1859,
-   -0.1490,
-   -0.1120,
-   -0.0747,
-   -0.0374,
-};
-
-#endif /*LUT_DEF_H_*/
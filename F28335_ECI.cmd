@@ -226,6 +226,10 @@ SECTIONS
    .bss				   : > RAMM0	   PAGE = 1
    .stack              : > RAMM1       PAGE = 1
    .ebss               : > RAML4       PAGE = 1
+   ctrlstate           : > RAML4       PAGE = 1    /* controller state structs, zero wait, away from the DMA buffer in L6 */
+   tracebuf            : > RAML7       PAGE = 1    /* trace recorder buffer, all of L7 */
+   capbuf              : > RAML6       PAGE = 1    /* golden-vector capture, the rest of L6 after DMARAML6 */
+   rackid              : > OTP         PAGE = 0, TYPE = DSECT    /* rack number word, programmed once per board, not part of the image */
    .esysmem            : > RAMM1       PAGE = 1
 
    /* Initalized sections go in Flash */
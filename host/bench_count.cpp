@@ -0,0 +1,27 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: bench_count.cpp
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		bench_kernels.inc with float32 = CountF, the op count half of
+ * 		kernel_bench (include/kernel_bench.h, include/count_float.h).
+ * *****************************************************************************
+ */
+
+#include <kernel_bench.h>
+#include <count_float.h>
+
+OP_COUNT CountOps;
+
+namespace BenchC
+{
+	typedef CountF float32;
+	#include "bench_kernels.inc"
+}
@@ -0,0 +1,239 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: eci_host.c
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		Host harness, see include/eci_host.h.  main.c is included as is, so the
+ * 		harness sees AdcDmaBuf[], CanRxHandler[] and the AIN_A()/AIN_B() slots
+ * 		of the build flags in ECI_API.h.
+ *
+ * 		Also stubs the TI library functions of source/ that wait on hardware
+ * 		(PLL lock, eCAN CCE) or are assembly (DSP28x_usDelay).
+ * *****************************************************************************
+ */
+
+#include <stdlib.h>
+#include "../main.c"
+#include <eci_host.h>
+
+typedef char HostPwmPdCheck[(HOST_PWM_PD == PWM_PD) ? 1 : -1];	//eci_host.h is in step with ECI_API.h
+#if(ADC_DMA)
+typedef char HostOversampleCheck[(HOST_ADC_OVERSAMPLE == ADC_OVERSAMPLE) ? 1 : -1];
+#else
+typedef char HostOversampleCheck[(HOST_ADC_OVERSAMPLE == 1) ? 1 : -1];
+#endif
+typedef char HostEnableCheck[(HOST_EN_AFE == EN_AFE && HOST_EN_INV == EN_INV && HOST_EN_NPC == EN_NPC) ? 1 : -1];
+
+volatile unsigned int IFR;					//C28x core registers.
+volatile unsigned int IER;
+
+volatile struct EPWM_REGS *const HostEPwm[6] = {&EPwm1Regs, &EPwm2Regs, &EPwm3Regs, &EPwm4Regs, &EPwm5Regs, &EPwm6Regs};
+const Uint16 HostAinA[8] = {AIN_A(0), AIN_A(1), AIN_A(2), AIN_A(3), AIN_A(4), AIN_A(5), AIN_A(6), AIN_A(7)};
+const Uint16 HostAinB[8] = {AIN_B(0), AIN_B(1), AIN_B(2), AIN_B(3), AIN_B(4), AIN_B(5), AIN_B(6), AIN_B(7)};
+Uint16 HostAdcSum[16];						//Sum of the HOST_ADC_OVERSAMPLE bursts of each result.
+
+struct HOST_CTRL
+{
+	CTRL_STATE s;
+	PARAM_VAL p[PARAM_MAX];					//Applied set.
+	Uint16 npc;								//RackProfile[].npc
+};
+
+/***********************************************************/
+//TI library stubs (source/DSP2833x_SysCtrl.c, _PieCtrl.c, _PieVect.c, _ECan.c, _usDelay.asm)
+/***********************************************************/
+void InitSysCtrl(void) {}
+void InitPieCtrl(void) {}
+void InitPieVectTable(void) {}
+void InitECanGpio(void) {}
+void InitECan(void) {}
+void DSP28x_usDelay(Uint32 Count) {(void)Count;}
+
+/***********************************************************/
+//Harness
+/***********************************************************/
+
+//HostLatchGpio(): The GPIO SET/CLEAR/TOGGLE registers act on GPxDAT, in that order.
+static void HostLatchGpio(void)
+{
+	GpioDataRegs.GPADAT.all = ((GpioDataRegs.GPADAT.all | GpioDataRegs.GPASET.all) & ~GpioDataRegs.GPACLEAR.all) ^ GpioDataRegs.GPATOGGLE.all;
+	GpioDataRegs.GPBDAT.all = ((GpioDataRegs.GPBDAT.all | GpioDataRegs.GPBSET.all) & ~GpioDataRegs.GPBCLEAR.all) ^ GpioDataRegs.GPBTOGGLE.all;
+	GpioDataRegs.GPCDAT.all = ((GpioDataRegs.GPCDAT.all | GpioDataRegs.GPCSET.all) & ~GpioDataRegs.GPCCLEAR.all) ^ GpioDataRegs.GPCTOGGLE.all;
+	GpioDataRegs.GPASET.all = GpioDataRegs.GPACLEAR.all = GpioDataRegs.GPATOGGLE.all = 0;
+	GpioDataRegs.GPBSET.all = GpioDataRegs.GPBCLEAR.all = GpioDataRegs.GPBTOGGLE.all = 0;
+	GpioDataRegs.GPCSET.all = GpioDataRegs.GPCCLEAR.all = GpioDataRegs.GPCTOGGLE.all = 0;
+}
+
+void HostBoot(void)
+{
+	InitBoard();
+	HostLatchGpio();
+}
+
+void HostTick(void)
+{
+#if(ADC_DMA)
+	Uint16 os, k;
+
+	for(os = 0; os < ADC_OVERSAMPLE; os++)					//DMA CH1, one burst per SEQ1INT, the
+		for(k = 0; k < ADC_CHANNELS; k++)					//	remainder of the sum in the first bursts
+			AdcDmaBuf[AdcDmaHalf][os*ADC_CHANNELS + k] = HostAdcSum[k]/ADC_OVERSAMPLE + (os < HostAdcSum[k]%ADC_OVERSAMPLE);
+#endif
+	timer_isr();
+	HostLatchGpio();
+}
+
+void HostSetAdc(Uint16 k, Uint16 val)
+{
+	(&AdcMirror.ADCRESULT0)[k] = val & 0x0FFF;
+	(&AdcRegs.ADCRESULT0)[k] = (val & 0x0FFF) << 4;			//left aligned copy
+	HostAdcSum[k] = (val & 0x0FFF)*HOST_ADC_OVERSAMPLE;
+}
+
+//HostSetAdcSum(): Bursts that differ by at most one count, for the oversampled sums of a capture.
+void HostSetAdcSum(Uint16 k, Uint16 sum)
+{
+	HostSetAdc(k, sum/HOST_ADC_OVERSAMPLE);
+	HostAdcSum[k] = sum;
+}
+
+void HostSetSkip(Uint16 skip) {LoadNextSkip = skip;}
+
+Uint32 HostCapture(const Uint16 **words)
+{
+	*words = (const Uint16 *)&CapBuf;
+	return (sizeof(CAP_HDR) + sizeof(CapBuf.p) + CapBuf.hdr.frames*sizeof(CAP_FRAME))/sizeof(Uint16);
+}
+
+void HostSetAinA(Uint16 n, Uint16 val) {HostSetAdc(HostAinA[n], val);}
+void HostSetAinB(Uint16 n, Uint16 val) {HostSetAdc(HostAinB[n], val);}
+
+//HostSetRack(): Rack jumpers DI9 (GPIO61) and DI10 (GPIO49), read at HostBoot() by SelectRack().
+void HostSetRack(Uint16 rack)
+{
+	HostSetGpio(61, !(rack & 1));							//jumper to ground sets the bit
+	HostSetGpio(49, !(rack & 2));
+}
+
+void HostSetRackOtp(Uint16 id) {RackIdOtp = id;}
+
+Uint16 HostGetRack(void) {return RackId;}
+
+Uint16 HostGetMonitor(Uint16 ch, float32 *gain, float32 *offset, Uint16 *div)
+{
+	*gain = MonRoute[ch].gain;
+	*offset = MonRoute[ch].offset;
+	*div = MonRoute[ch].div;
+	return MonRoute[ch].sig;
+}
+
+void HostSetGpio(Uint16 n, Uint16 level)
+{
+	volatile Uint32 *dat = (n < 32) ? &GpioDataRegs.GPADAT.all : (n < 64) ? &GpioDataRegs.GPBDAT.all : &GpioDataRegs.GPCDAT.all;
+	Uint32 bit = (Uint32)1 << (n & 31);
+
+	*dat = level ? (*dat | bit) : (*dat & ~bit);
+}
+
+//HostCanRx(): Runs the handler directly, ecan0_isr() would spin on the mock CANGIF0.
+void HostCanRx(Uint16 n, Uint32 mdl, Uint32 mdh)
+{
+	volatile struct MBOX *mb = &(&ECanaMboxes.MBOX0)[n];
+
+	mb->MDL.all = mdl;
+	mb->MDH.all = mdh;
+	if(CanRxHandler[n]) CanRxHandler[n](mb);
+	CanRxCount++;
+	HostLatchGpio();
+}
+
+//HostCanTx(): 1 and the message if mailbox n was given one to send (CANTRS).  The mock bus takes
+//	it at once, the next SendCanMbox() on n goes out.
+Uint16 HostCanTx(Uint16 n, Uint32 *mdl, Uint32 *mdh)
+{
+	Uint32 bit = (Uint32)1 << n;
+	volatile struct MBOX *mb = &(&ECanaMboxes.MBOX0)[n];
+
+	if(!(ECanaRegs.CANTRS.all & bit)) return 0;
+	*mdl = mb->MDL.all;
+	*mdh = mb->MDH.all;
+	ECanaRegs.CANTRS.all &= ~bit;
+	ECanaRegs.CANTA.all |= bit;
+	return 1;
+}
+
+Uint16 HostGetCmpa(Uint16 m) {return HostEPwm[m - 1]->CMPA.half.CMPA;}
+Uint16 HostGetCmpb(Uint16 m) {return HostEPwm[m - 1]->CMPB;}
+
+Uint16 HostGetGpio(Uint16 n)
+{
+	Uint32 dat = (n < 32) ? GpioDataRegs.GPADAT.all : (n < 64) ? GpioDataRegs.GPBDAT.all : GpioDataRegs.GPCDAT.all;
+
+	return (dat >> (n & 31)) & 1;
+}
+
+/***********************************************************/
+//Controller instances, apart from Ctrl and the ISR
+/***********************************************************/
+
+HOST_CTRL *HostCtrlNew(Uint16 rack)
+{
+	HOST_CTRL *c = malloc(sizeof(HOST_CTRL));
+
+	if(!c) return 0;
+	InitCtrlState(&c->s);
+	memset(c->p, 0, sizeof(c->p));
+	DefaultParams(ParamDef, PARAMS, c->p);
+	ApplyParamsCtrl(&c->s, c->p);
+	c->npc = RackProfile[rack % RACK_PROFILES].npc;
+	return c;
+}
+
+void HostCtrlFree(HOST_CTRL *c) {free(c);}
+
+//HostCtrlSetParam(): Checked like WriteParam(), then the whole set is applied, as a commit does.
+Uint16 HostCtrlSetParam(HOST_CTRL *c, Uint16 i, Uint32 val)
+{
+	PARAM_VAL v;
+
+	v.u = val;
+	if(i >= PARAMS) return PARAM_ERR_INDEX;
+	if(CheckParam(&ParamDef[i], v) != PARAM_OK) return PARAM_ERR_RANGE;
+	c->p[i] = v;
+	ApplyParamsCtrl(&c->s, c->p);
+	return PARAM_OK;
+}
+
+Uint32 HostCtrlGetParam(const HOST_CTRL *c, Uint16 i) {return (i < PARAMS) ? c->p[i].u : 0;}
+
+//HostCtrlTick(): The control step of timer_isr() without the skips, the compares in EPwm order.
+void HostCtrlTick(HOST_CTRL *c, const Uint16 *adc, Uint16 enable, Uint16 *cmp)
+{
+	float32 ain[HOST_ADC];
+	Uint16 k;
+
+	for(k = 0; k < HOST_ADC; k++) ain[k] = (float32)adc[k];
+	if(c->npc)
+	{
+		StepCtrlNPC(&c->s, ain, enable, 0);
+		for(k = 0; k < HOST_PWM; k++) cmp[k] = c->s.npc.cmp[k];
+	}
+	else
+	{
+		StepCtrlB2B(&c->s, ain, enable, 0);
+		for(k = 0; k < 3; k++)
+		{
+			cmp[k] = c->s.afe.cmp[k];
+			cmp[3 + k] = c->s.inv.cmp[k];
+		}
+	}
+}
+
+Uint16 HostParamCount(void) {return PARAMS;}
@@ -0,0 +1,307 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: eci_plant.c
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		Converter plant, see include/eci_plant.h.  Host only, double precision,
+ * 		explicit integration with the capacitor voltages updated from the new
+ * 		inductor currents.
+ * *****************************************************************************
+ */
+
+#include <math.h>
+#include <string.h>
+#include <eci_plant.h>
+
+#define PI_D 3.14159265358979
+#define PWM_R_GPIO 34				//AFE gate driver enable, active low (EnablePWM_R()).
+#define PWM_I_GPIO 35				//INV gate driver enable, active low (EnablePWM_I()).
+
+//ADC scale factors of main.c [unit per count].
+#define ADC_SCALE_I 0.01723
+#define ADC_SCALE_V 0.1705
+#define ADC_SCALE_VDC 0.2687
+
+const PLANT_CFG PlantDefault =
+{
+	170.0, 60.0,					//120 Vrms grid
+	0.0012, 0.05,					//input inductor
+	1.5e-3, 20e3,					//Cdc, r_bleed
+	1.2e-3, 0.05, 20e-6,			//INV filter
+	PLANT_LOAD_R, 10.0, 1e-3,		//4.3 kW at vidref = 170 V
+	1.0,							//r_diode
+	3e-3, 3e-3, 50.0,				//NPC DC link, 2.6 kW at 360 V
+	40,
+};
+
+//OnFraction(): Part of [t0 t1] (TBCLK counts from TBCTR = 0, one period = 2*PWM_PD) where the
+//	A output is high, TBCTR < cmp.  The step lies in one half of the carrier.
+static double OnFraction(double t0, double t1, double cmp)
+{
+	double lo, hi;
+
+	if(t0 < HOST_PWM_PD)	{lo = t0; hi = (t1 < cmp) ? t1 : cmp;}					//up: high before cmp
+	else					{lo = (t0 > 2*HOST_PWM_PD - cmp) ? t0 : 2*HOST_PWM_PD - cmp; hi = t1;}	//down: high after 2*PD - cmp
+	return (hi > lo) ? (hi - lo)/(t1 - t0) : 0.0;
+}
+
+//DiodeBridge(): Three phase diode bridge from v[] into vdc through r.  Returns the DC current,
+//	phase currents into the bridge in i[].
+static double DiodeBridge(const double v[3], double vdc, double r, double i[3])
+{
+	Uint16 hi = 0, lo = 0, k;
+	double id;
+
+	for(k = 1; k < 3; k++)
+	{
+		if(v[k] > v[hi]) hi = k;
+		if(v[k] < v[lo]) lo = k;
+	}
+	id = (v[hi] - v[lo] - vdc)/r;
+	if(id < 0.0) id = 0.0;
+	i[0] = i[1] = i[2] = 0.0;
+	i[hi] = id;
+	i[lo] = -id;
+	return id;
+}
+
+//RemoveZero(): Three wire, no zero sequence.
+static void RemoveZero(double x[3])
+{
+	double m = (x[0] + x[1] + x[2])*(1.0/3.0);
+
+	x[0] -= m;
+	x[1] -= m;
+	x[2] -= m;
+}
+
+static Uint16 AdcCode(double x, double scale)
+{
+	double c = floor(x/scale + 2048.5);
+
+	return (c < 0.0) ? 0 : (c > 4095.0) ? 4095 : (Uint16)c;
+}
+
+//StepGrid(): Grid side over dt.  fp[] is the part of the step each leg is on the upper rail,
+//	fn[] on the lower rail (NPC only, 0 for B2B where the lower rail is the reference).  Returns
+//	the currents from the phases into the upper (*ip) and lower (*in) rails.
+static void StepGrid(PLANT *p, const double fp[3], const double fn[3], Uint16 on, double dt, double *ip, double *in)
+{
+	const PLANT_CFG *c = &p->cfg;
+	double vr[3];
+	Uint16 k;
+
+	if(!on)
+	{
+		*ip = DiodeBridge(p->vg, p->Vdc, c->r_diode, p->ig);
+		*in = -*ip;
+		return;
+	}
+	for(k = 0; k < 3; k++)
+		vr[k] = p->npc ? fp[k]*p->vc1 - fn[k]*p->vc2 : fp[k]*p->Vdc;
+	RemoveZero(vr);
+	*ip = *in = 0.0;
+	for(k = 0; k < 3; k++)
+	{
+		p->ig[k] += (p->vg[k] - c->r_L*p->ig[k] - vr[k])*dt/c->L;
+		*ip += fp[k]*p->ig[k];
+		*in += fn[k]*p->ig[k];
+	}
+	RemoveZero(p->ig);
+}
+
+//StepINV(): Inverter, filter and load over dt, legs fi[] relative to the DC negative.  Returns
+//	the DC current drawn.
+static double StepINV(PLANT *p, const double fi[3], Uint16 on, double dt)
+{
+	const PLANT_CFG *c = &p->cfg;
+	double vi[3], il[3];
+	double idc = 0.0;
+	Uint16 k;
+
+	for(k = 0; k < 3; k++) vi[k] = fi[k]*p->Vdc;
+	RemoveZero(vi);
+	for(k = 0; k < 3; k++)
+	{
+		if(on) p->iL[k] += (vi[k] - c->r_Lf*p->iL[k] - p->vcf[k])*dt/c->Lf;
+		else p->iL[k] = 0.0;
+		idc += fi[k]*p->iL[k];
+	}
+	RemoveZero(p->iL);
+
+	if(c->load == PLANT_LOAD_DIODE)
+	{
+		double id = DiodeBridge(p->vcf, p->vcl, c->r_diode, il);
+
+		p->vcl += (id - p->vcl/c->R_load)*dt/c->C_load;
+	}
+	else
+		for(k = 0; k < 3; k++) il[k] = p->vcf[k]/c->R_load;
+	for(k = 0; k < 3; k++) p->vcf[k] += (p->iL[k] - il[k])*dt/c->Cf;
+	RemoveZero(p->vcf);
+	return idc;
+}
+
+//SampleADC(): Adds one sample of every measurement to acc[] (ADC result index).
+static void SampleADC(const PLANT *p, double acc[2][8])
+{
+	Uint16 k;
+
+	for(k = 0; k < 3; k++) acc[1][2 + k] += p->ig[k];			//B2-B4
+	if(p->npc)
+	{
+		acc[1][0] += p->vg[0] - p->vg[1];						//B0 vab
+		acc[1][1] += p->vg[1] - p->vg[2];						//B1 vbc
+		acc[0][0] += p->vc1;									//A0
+		acc[0][1] += p->vc2;									//A1
+	}
+	else
+	{
+		acc[1][0] += p->vg[0];									//B0, B1, B6
+		acc[1][1] += p->vg[1];
+		acc[1][6] += p->vg[2];
+		acc[1][5] += p->Vdc;									//B5
+		acc[0][0] += p->vcf[0];									//A0, A1, A6
+		acc[0][1] += p->vcf[1];
+		acc[0][6] += p->vcf[2];
+	}
+}
+
+//WriteADC(): Averages acc[] into p->adc[], unused channels at mid scale.
+static void WriteADC(PLANT *p, double acc[2][8])
+{
+	const double a = 1.0/PLANT_ADC_SAMPLES;
+	Uint16 *A = p->adc, k;
+	const Uint16 *ia = HostAinA, *ib = HostAinB;
+
+	for(k = 0; k < HOST_ADC; k++) A[k] = 2048;
+	for(k = 2; k < 5; k++) A[ib[k]] = AdcCode(acc[1][k]*a, ADC_SCALE_I);
+	if(p->npc)
+	{
+		A[ib[0]] = AdcCode(acc[1][0]*a, ADC_SCALE_V);
+		A[ib[1]] = AdcCode(acc[1][1]*a, ADC_SCALE_V);
+		A[ia[0]] = AdcCode(acc[0][0]*a, ADC_SCALE_VDC);
+		A[ia[1]] = AdcCode(acc[0][1]*a, ADC_SCALE_VDC);
+	}
+	else
+	{
+		A[ib[0]] = AdcCode(acc[1][0]*a, ADC_SCALE_V);
+		A[ib[1]] = AdcCode(acc[1][1]*a, ADC_SCALE_V);
+		A[ib[6]] = AdcCode(acc[1][6]*a, ADC_SCALE_V);
+		A[ib[5]] = AdcCode(acc[1][5]*a, ADC_SCALE_VDC);
+		A[ia[0]] = AdcCode(acc[0][0]*a, ADC_SCALE_V);
+		A[ia[1]] = AdcCode(acc[0][1]*a, ADC_SCALE_V);
+		A[ia[6]] = AdcCode(acc[0][6]*a, ADC_SCALE_V);
+	}
+}
+
+//SetADC(): p->adc[] into the harness ADC results.
+static void SetADC(const PLANT *p)
+{
+	Uint16 k;
+
+	for(k = 0; k < HOST_ADC; k++) HostSetAdc(k, p->adc[k]);
+}
+
+void InitPlantModel(PLANT *p, const PLANT_CFG *cfg, Uint16 rack)
+{
+	double acc[2][8];
+	Uint16 k;
+
+	memset(p, 0, sizeof(*p));
+	p->cfg = *cfg;
+	if(p->cfg.substeps < 2*PLANT_ADC_SAMPLES) p->cfg.substeps = 2*PLANT_ADC_SAMPLES;
+	p->cfg.substeps -= p->cfg.substeps % (2*PLANT_ADC_SAMPLES);
+	p->npc = rack >= 2;
+	p->Vdc = sqrt(3.0)*cfg->vg - 2*cfg->r_diode;			//precharged through the diodes
+	p->vc1 = p->vc2 = 0.5*p->Vdc;
+
+	for(k = 0; k < 3; k++) p->vg[k] = cfg->vg*sin(-k*(2*PI_D/3));
+
+	memset(acc, 0, sizeof(acc));
+	for(k = 0; k < PLANT_ADC_SAMPLES; k++) SampleADC(p, acc);
+	WriteADC(p, acc);										//for the first ISR
+}
+
+void InitPlant(PLANT *p, const PLANT_CFG *cfg, Uint16 rack)
+{
+	InitPlantModel(p, cfg, rack);
+	HostSetRack(rack);
+	HostBoot();
+	SetADC(p);
+}
+
+void StepPlantModel(PLANT *p, const Uint16 *cmpa, Uint16 on_r, Uint16 on_i)
+{
+	const PLANT_CFG *c = &p->cfg;
+	const Uint16 n = c->substeps;
+	const double T = 1.0/HOST_ISR_HZ;
+	const double dt = T/n;
+	const double w = 2*PI_D*c->f;
+	const double span = 2.0*HOST_PWM_PD/n;						//TBCLK counts per step
+	double cmp[6], f[6], fn[3], acc[2][8];
+	double ip, in, ii;
+	Uint16 j, k;
+
+	for(k = 0; k < 6; k++) cmp[k] = cmpa[k];
+	memset(acc, 0, sizeof(acc));
+
+	for(j = 0; j < n; j++)
+	{
+		double t0 = j*span;
+
+		for(k = 0; k < 3; k++) p->vg[k] = c->vg*sin(w*p->t - k*(2*PI_D/3));
+		if(j % (n/PLANT_ADC_SAMPLES) == 0) SampleADC(p, acc);
+
+		for(k = 0; k < 6; k++) f[k] = OnFraction(t0, t0 + span, cmp[k]);
+		if(p->npc)
+		{
+			//EPwm 2k+1 is S1 of phase k, EPwm 2k+2 is S2, B outputs complementary (S3, S4).
+			//P while S1 is on, N while S2 is off.
+			double fp[3];
+
+			for(k = 0; k < 3; k++)
+			{
+				fp[k] = f[2*k];
+				fn[k] = 1.0 - f[2*k + 1];
+			}
+			StepGrid(p, fp, fn, on_r, dt, &ip, &in);
+			p->vc1 += (ip - p->Vdc/c->R_dc)*dt/c->C1;
+			p->vc2 += (-in - p->Vdc/c->R_dc)*dt/c->C2;
+			p->Vdc = p->vc1 + p->vc2;
+		}
+		else
+		{
+			fn[0] = fn[1] = fn[2] = 0.0;
+			StepGrid(p, f, fn, on_r, dt, &ip, &in);
+			ii = StepINV(p, f + 3, on_i, dt);
+			p->Vdc += (ip - ii - p->Vdc/c->r_bleed)*dt/c->Cdc;
+		}
+		p->t += dt;
+	}
+
+	WriteADC(p, acc);
+	p->ticks++;
+}
+
+void StepPlant(PLANT *p)
+{
+	Uint16 cmpa[HOST_PWM], k;
+
+	for(k = 0; k < HOST_PWM; k++) cmpa[k] = HostGetCmpa(k + 1);
+	StepPlantModel(p, cmpa, !HostGetGpio(PWM_R_GPIO), !HostGetGpio(PWM_I_GPIO));
+	SetADC(p);
+	HostTick();
+}
+
+void RunPlant(PLANT *p, Uint32 ticks)
+{
+	while(ticks--) StepPlant(p);
+}
@@ -0,0 +1,70 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: gen_sinlut.c
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		Generates API/ECI_SinLUT.h, the quarter-wave sine table read by
+ * 		SinPhase() in ECI_Trig.h.  Run from 'make -C host sinlut'.
+ *
+ * 		ex:	gen_sinlut 10 > ../API/ECI_SinLUT.h
+ *
+ * 		The argument is log2 of the full-wave table length (6 to 14).  Only the
+ * 		first quarter is stored, plus two points past 90 deg so the linear
+ * 		interpolation never needs a bounds check.  Values are computed in double
+ * 		and rounded once to float32.
+ * *****************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+int main(int argc, char *argv[])
+{
+	int bits = (argc > 1) ? atoi(argv[1]) : 10;
+	int quarter, i;
+
+	if(bits < 6 || bits > 14)
+	{
+		fprintf(stderr, "gen_sinlut: table bits must be 6 to 14, got %d\n", bits);
+		return 1;
+	}
+	quarter = 1 << (bits - 2);
+
+	printf("/* DSP Controller Project\n");
+	printf(" * Energy Conversion and Integration Group\n");
+	printf(" * Center for Advanced Power Systems\n");
+	printf(" * Florida State University\n");
+	printf(" * ******************************************************************************\n");
+	printf(" *\n");
+	printf(" * Filename: ECI_SinLUT.h\n");
+	printf(" *\n");
+	printf(" * Generated by host/gen_sinlut.c ('make -C host sinlut SIN_LUT_BITS=%d').\n", bits);
+	printf(" * Do not edit, regenerate instead.\n");
+	printf(" *\n");
+	printf(" * ******************************************************************************\n");
+	printf(" * Purpose:\n");
+	printf(" * \t\tFirst quarter of a %d point sine wave, sin(i*pi/2/%d) for\n", 1 << bits, quarter);
+	printf(" * \t\ti = 0..%d.  The last two points run past 90 deg for interpolation.\n", quarter + 1);
+	printf(" * \t\tRead through SinPhase() in ECI_Trig.h.  Being const, the table is in\n");
+	printf(" * \t\t.econst, which is copied from flash to RAML5 at boot.\n");
+	printf(" * *****************************************************************************\n");
+	printf(" */\n\n");
+	printf("#ifndef ECI_SINLUT_H\n");
+	printf("#define ECI_SINLUT_H\n\n");
+	printf("#define SIN_LUT_BITS %d\t\t\t\t//log2 of the full-wave length.\n", bits);
+	printf("#define SIN_LUT_QUARTER %d\t\t\t//Points per quarter wave.\n\n", quarter);
+	printf("const float32 SinLUT[SIN_LUT_QUARTER + 2] =\n{\n");
+	for(i = 0; i <= quarter + 1; i++)
+		printf("\t%.9ef%s\n", (float)sin(i*(M_PI/2.0)/quarter), (i <= quarter) ? "," : "");
+	printf("};\n\n");
+	printf("#endif /*ECI_SINLUT_H*/\n");
+	return 0;
+}
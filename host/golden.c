@@ -0,0 +1,261 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: golden.c
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		Golden-vector record and replay of timer_isr() (API/ECI_Capture.h).
+ *
+ * 			./golden record file.cap [rack 0-3] [seconds] [diode]
+ * 			./golden replay file.cap|file.dat [tol] [-v] [-p]
+ *
+ * 		record runs the closed-loop start up of plant_sim.c (AFE at 50 ms, INV at
+ * 		0.3 s), steps Vdcref to 380 V over the parameter protocol at 0.45 s and
+ * 		saves CapBuf, raw little endian words, up to CAP_FRAMES ticks.
+ *
+ * 		replay boots the rack of the capture header and refuses a capture that
+ * 		was armed after boot (CapArmReq), then per frame delivers
+ * 		the recorded CAN enables when they change, forces the recorded IsrSkip,
+ * 		writes the ADC sums, runs one tick and diffs the six CMPA against the
+ * 		capture.  A .dat file is a CCS Memory Save of CapBuf from the target
+ * 		(header line "1651 1 ...", one 0x word per line).  Prints the bit exact
+ * 		frames and the largest difference per EPwm, and exits 1 if any compare
+ * 		is more than tol counts off (default 0, bit exact).  Before a frame with a
+ * 		parameter commit (CAP_F_PARAM) the logged values are written and
+ * 		committed over the parameter mailbox.  From a commit that was not fully
+ * 		logged (CAP_F_PARAM_LOST) on the frames cannot be compared, and the
+ * 		replay exits 1 unless -p allows a partial comparison.
+ *
+ * 		Captures from the host are bit exact against an unchanged main.c.
+ * 		Target captures go through the C28x FPU rounding and the target trig
+ * 		tables, so give them a tolerance of a few counts.
+ * *****************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <eci_plant.h>
+
+#define CAP_LAYOUT_ONLY
+#include <ECI_Capture.h>
+
+#undef main						//ti_host.h renames main.c's main(), this is the host one.
+
+#define T_AFE 0.05					//AFE enable [s], as plant_sim.c
+#define T_INV 0.3					//INV enable [s]
+#define ENABLE_MBOX 1				//mailboxes of main.c
+#define INV_MBOX 2
+#define PARAM_MBOX 4
+#define PARAM_CMD_WRITE 2			//ECI_Param.h
+#define PARAM_CMD_COMMIT 3
+#define PARAM_VDCREF 12				//parameter numbers of main.c
+#define T_PARAM 0.45				//Vdcref step [s]
+#define VDCREF_STEP 380.0f			//[V]
+#define CCS_DAT_MAGIC 1651			//first word of a CCS memory save
+
+//SaveCapture(): CapBuf as recorded so far.
+int SaveCapture(const char *path)
+{
+	const Uint16 *w;
+	Uint32 n = HostCapture(&w);
+	FILE *f = fopen(path, "wb");
+
+	if(!f) return 1;
+	fwrite(w, sizeof(Uint16), n, f);
+	return fclose(f) != 0;
+}
+
+//LoadCapture(): Words of a raw or CCS .dat capture into *w, returns the count, 0 on error.
+Uint32 LoadCapture(const char *path, Uint16 **w)
+{
+	FILE *f = fopen(path, "rb");
+	Uint32 n = 0, cap = 4096, x;
+	unsigned magic, fmt, start, page, len;
+	int dat;
+
+	if(!f) return 0;
+	dat = (fscanf(f, "%u %u %x %u %x", &magic, &fmt, &start, &page, &len) == 5 && magic == CCS_DAT_MAGIC);
+	if(!dat) rewind(f);
+	*w = malloc(cap*sizeof(Uint16));
+	while(*w)
+	{
+		if(n == cap) *w = realloc(*w, (cap *= 2)*sizeof(Uint16));
+		if(dat ? fscanf(f, "%x", &x) != 1 : fread(&(*w)[n], sizeof(Uint16), 1, f) != 1) break;
+		if(dat) (*w)[n] = x;
+		n++;
+	}
+	fclose(f);
+	return *w ? n : 0;
+}
+
+//SendParam(): Writes parameter i over the parameter protocol, value as PARAM_VAL.u.
+void SendParam(Uint16 i, Uint32 u)
+{
+	HostCanRx(PARAM_MBOX, ((Uint32)PARAM_CMD_WRITE << 24) | i, u);
+}
+
+//CommitParam(): Applies the written parameters at the next tick.
+void CommitParam()
+{
+	HostCanRx(PARAM_MBOX, (Uint32)PARAM_CMD_COMMIT << 24, 0);
+}
+
+int Record(int argc, char **argv)
+{
+	Uint16 rack = (argc > 3) ? atoi(argv[3]) & 3 : 0;
+	double seconds = (argc > 4) ? atof(argv[4]) : (double)CAP_FRAMES/HOST_ISR_HZ;
+	Uint32 ticks = seconds*HOST_ISR_HZ, t_afe = T_AFE*HOST_ISR_HZ, t_inv = T_INV*HOST_ISR_HZ, t_param = T_PARAM*HOST_ISR_HZ;
+	PLANT_CFG cfg = PlantDefault;
+	PLANT p;
+	union {float32 f; Uint32 u;} vdcref;
+
+	if(argc > 5) cfg.load = PLANT_LOAD_DIODE;
+	if(ticks > CAP_FRAMES) ticks = CAP_FRAMES;
+	InitPlant(&p, &cfg, rack);
+	while(p.ticks < ticks)
+	{
+		if(p.ticks == t_afe) HostCanRx(ENABLE_MBOX, 0x01000000, 0);
+		if(p.ticks == t_inv && !p.npc) HostCanRx(INV_MBOX, 0x01000000, 0);
+		if(p.ticks == t_param)
+		{
+			vdcref.f = VDCREF_STEP;
+			SendParam(PARAM_VDCREF, vdcref.u);
+			CommitParam();
+		}
+		StepPlant(&p);
+	}
+	if(SaveCapture(argv[2]))
+	{
+		fprintf(stderr, "golden: cannot write %s\n", argv[2]);
+		return 2;
+	}
+	printf("%s: rack %u, %lu frames, Vdc %.1f V\n", argv[2], rack, (unsigned long)p.ticks, p.Vdc);
+	return 0;
+}
+
+//SendEnable(): Recorded enable bit of flags to mailbox n, if it changed.
+void SendEnable(Uint16 flags, Uint16 last, Uint16 bit, Uint16 n)
+{
+	if((flags ^ last) & bit) HostCanRx(n, (flags & bit) ? 0x01000000 : 0, 0);
+}
+
+//SendLogged(): Writes and commits the logged parameters of frame, the commit goes live in its tick.
+void SendLogged(const CAP_PARAM *p, Uint16 n, Uint32 frame)
+{
+	Uint16 k;
+
+	for(k = 0; k < n; k++)
+		if(p[k].frame == frame) SendParam(p[k].index, ((Uint32)p[k].val_hi << 16) | p[k].val_lo);
+	CommitParam();
+}
+
+int Replay(int argc, char **argv)
+{
+	Uint16 *w;
+	Uint32 words = LoadCapture(argv[2], &w);
+	const CAP_HDR *h = (const CAP_HDR *)w;
+	const CAP_PARAM *log = (const CAP_PARAM *)(h + 1);
+	const CAP_FRAME *f;
+	int tol = 0, verbose = 0, partial = 0, d, dmax[CAP_PWM];
+	Uint32 i, frames, exact = 0, over = 0, first_over = 0, compared;
+	Uint16 k, last = 0, diff, same;
+	int a;
+
+	for(a = 3; a < argc; a++)
+	{
+		if(!strcmp(argv[a], "-v")) verbose = 1;
+		else if(!strcmp(argv[a], "-p")) partial = 1;
+		else tol = atoi(argv[a]);
+	}
+	if(words < (sizeof(CAP_HDR) + sizeof(CAP_PARAM)*CAP_PARAMS)/sizeof(Uint16) || h->magic != CAP_MAGIC || h->frame_words != sizeof(CAP_FRAME)/sizeof(Uint16))
+	{
+		fprintf(stderr, "golden: %s is not a capture (magic %04X)\n", argv[2], words ? w[0] : 0);
+		return 2;
+	}
+	if(h->oversample != HOST_ADC_OVERSAMPLE)
+	{
+		fprintf(stderr, "golden: captured with ADC_OVERSAMPLE %u, host build has %u\n", h->oversample, HOST_ADC_OVERSAMPLE);
+		return 2;
+	}
+	frames = (words - (sizeof(CAP_HDR) + sizeof(CAP_PARAM)*CAP_PARAMS)/sizeof(Uint16))/h->frame_words;
+	if(frames > h->frames) frames = h->frames;
+	if(h->start_hi || h->start_lo)
+	{
+		fprintf(stderr, "golden: %s starts at tick %lu, not at boot, the controller state is not in the capture\n",
+			argv[2], ((unsigned long)h->start_hi << 16) | h->start_lo);
+		free(w);
+		return 2;
+	}
+
+	memset(dmax, 0, sizeof(dmax));
+	HostSetRack(h->rack);
+	HostBoot();
+	f = (const CAP_FRAME *)(log + CAP_PARAMS);
+	for(i = 0; i < frames; i++, f++)
+	{
+		if(f->flags & CAP_F_PARAM_LOST)
+		{
+			printf("#parameter commit at frame %lu not fully logged, not compared from here\n", (unsigned long)i);
+			break;
+		}
+		if(f->flags & CAP_F_PARAM) SendLogged(log, (h->params < CAP_PARAMS) ? h->params : CAP_PARAMS, i);
+		if(h->rack >= 2)
+			SendEnable(f->flags, last, CAP_F_NPC, ENABLE_MBOX);
+		else
+		{
+			SendEnable(f->flags, last, CAP_F_AFE, ENABLE_MBOX);
+			SendEnable(f->flags, last, CAP_F_INV, INV_MBOX);
+		}
+		last = f->flags;
+		HostSetSkip(f->flags >> CAP_F_SKIP_SHIFT);
+		for(k = 0; k < CAP_ADC; k++) HostSetAdcSum(k, f->adc[k]);
+		HostTick();
+
+		diff = 0;
+		same = 1;
+		for(k = 0; k < CAP_PWM; k++)
+		{
+			d = abs((int)HostGetCmpa(k + 1) - (int)f->cmpa[k]);
+			if(d > dmax[k]) dmax[k] = d;
+			if(d > tol) diff = 1;
+			if(d) same = 0;
+			if(d && verbose) printf("%lu\tEPwm%u\t%u\t%u\n", (unsigned long)i, k + 1, f->cmpa[k], HostGetCmpa(k + 1));
+		}
+		if(diff && over++ == 0) first_over = i;
+		exact += same;
+	}
+	compared = i;
+
+	printf("%s: rack %u, %lu of %lu frames compared, %lu bit exact, max |dCMPA|", argv[2], h->rack,
+		(unsigned long)compared, (unsigned long)frames, (unsigned long)exact);
+	for(k = 0; k < CAP_PWM; k++) printf(" %d", dmax[k]);
+	printf("\n");
+	free(w);
+	if(over)
+	{
+		printf("FAIL: %lu frames over %d counts, first at frame %lu\n", (unsigned long)over, tol, (unsigned long)first_over);
+		return 1;
+	}
+	if(compared < frames && !partial)
+	{
+		printf("FAIL: %lu frames not compared, -p to allow\n", (unsigned long)(frames - compared));
+		return 1;
+	}
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	if(argc > 2 && !strcmp(argv[1], "record")) return Record(argc, argv);
+	if(argc > 2 && !strcmp(argv[1], "replay")) return Replay(argc, argv);
+	fprintf(stderr, "usage: golden record file.cap [rack] [seconds] [diode]\n"
+					"       golden replay file.cap|file.dat [tol] [-v] [-p]\n");
+	return 2;
+}
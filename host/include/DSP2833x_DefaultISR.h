@@ -0,0 +1,2 @@
+// Host build only: case alias for headers/DSP2833x_DefaultIsr.h.
+#include "DSP2833x_DefaultIsr.h"
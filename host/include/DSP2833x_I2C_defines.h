@@ -0,0 +1,2 @@
+// Host build only: case alias for headers/DSP2833x_I2c_defines.h.
+#include "DSP2833x_I2c_defines.h"
@@ -0,0 +1,3 @@
+// Host build only: the TI headers include this file with a different case than
+// the one shipped in headers/, which matters on a case-sensitive file system.
+#include "DSP2833x_Mcbsp.h"
@@ -0,0 +1,2 @@
+// Host build only: case alias for headers/DSP2833x_EPwm_defines.h.
+#include "DSP2833x_EPwm_defines.h"
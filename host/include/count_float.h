@@ -0,0 +1,93 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: count_float.h
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		Counting stand-in for float32 (C++), for the op counts of kernel_bench.
+ * 		The API headers are compiled unchanged with float32 = CountF, and every
+ * 		float operation they do is tallied in CountOps:
+ *
+ * 			add		+, -, unary -, +=, -=
+ * 			mul		*, *=
+ * 			div		/, /=
+ * 			cmp		<, >, <=, >=, ==, !=
+ * 			cvt		int -> float (construction from an integer type) and
+ * 					float -> int (any explicit cast out)
+ * 			trig	sinf/cosf and the double libm SinD/CosD
+ *
+ * 		Construction from a float or double (literals, table entries) and
+ * 		copies are free, like a load on the C28x.  Integer literals in float
+ * 		expressions count as a cvt although the compiler folds them, so the
+ * 		kernels write float literals.
+ *
+ * 		ex:	ClearCountOps();
+ * 			y = UpdatePI(&pi, e);			//PI_CTRL of CountF
+ * 			printf("%u mul\n", CountOps.mul);
+ * *****************************************************************************
+ */
+
+#ifndef COUNT_FLOAT_H
+#define COUNT_FLOAT_H
+
+#include <math.h>
+#include <string.h>
+
+//Operation tallies.
+typedef struct
+{
+	Uint32 add, mul, div, cmp, cvt, trig;
+} OP_COUNT;
+
+extern OP_COUNT CountOps;
+
+inline void ClearCountOps() {memset(&CountOps, 0, sizeof(CountOps));}
+
+class CountF
+{
+public:
+	float v;
+
+	CountF() {}
+	CountF(float x) : v(x) {}
+	CountF(double x) : v((float)x) {}
+	CountF(int x) : v((float)x) {CountOps.cvt++;}
+	CountF(unsigned x) : v((float)x) {CountOps.cvt++;}
+	CountF(long x) : v((float)x) {CountOps.cvt++;}
+	CountF(unsigned long x) : v((float)x) {CountOps.cvt++;}
+
+	template<typename T> explicit operator T() const {CountOps.cvt++; return (T)v;}	//(Uint16), (int32) ...
+
+	CountF &operator+=(CountF b) {CountOps.add++; v += b.v; return *this;}
+	CountF &operator-=(CountF b) {CountOps.add++; v -= b.v; return *this;}
+	CountF &operator*=(CountF b) {CountOps.mul++; v *= b.v; return *this;}
+	CountF &operator/=(CountF b) {CountOps.div++; v /= b.v; return *this;}
+};
+
+inline CountF operator+(CountF a, CountF b) {CountOps.add++; return CountF(a.v + b.v);}
+inline CountF operator-(CountF a, CountF b) {CountOps.add++; return CountF(a.v - b.v);}
+inline CountF operator-(CountF a) {CountOps.add++; return CountF(-a.v);}
+inline CountF operator*(CountF a, CountF b) {CountOps.mul++; return CountF(a.v*b.v);}
+inline CountF operator/(CountF a, CountF b) {CountOps.div++; return CountF(a.v/b.v);}
+
+inline bool operator<(CountF a, CountF b) {CountOps.cmp++; return a.v < b.v;}
+inline bool operator>(CountF a, CountF b) {CountOps.cmp++; return a.v > b.v;}
+inline bool operator<=(CountF a, CountF b) {CountOps.cmp++; return a.v <= b.v;}
+inline bool operator>=(CountF a, CountF b) {CountOps.cmp++; return a.v >= b.v;}
+inline bool operator==(CountF a, CountF b) {CountOps.cmp++; return a.v == b.v;}
+inline bool operator!=(CountF a, CountF b) {CountOps.cmp++; return a.v != b.v;}
+
+inline CountF sinf(CountF x) {CountOps.trig++; return CountF(::sinf(x.v));}
+inline CountF cosf(CountF x) {CountOps.trig++; return CountF(::cosf(x.v));}
+inline CountF SinD(CountF x) {CountOps.trig++; return CountF(sin((double)x.v));}
+inline CountF CosD(CountF x) {CountOps.trig++; return CountF(cos((double)x.v));}
+
+inline float RawValue(CountF x) {return x.v;}
+
+#endif /*COUNT_FLOAT_H*/
@@ -0,0 +1,90 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: eci_host.h
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		Host (PC) harness around the unmodified main.c.  The peripheral register
+ * 		structs of DSP2833x_GlobalVariableDefs.c are plain RAM on the host (the
+ * 		DATA_SECTION pragmas are ignored), so a test writes the ADC results and
+ * 		GPIO inputs, runs the control ISR and reads back the ePWM compares and
+ * 		GPIO outputs.  Nothing runs by itself: there is no clock, HostTick() is
+ * 		one control period.
+ *
+ * 		HostTick() does what the hardware does around timer_isr(): the DMA copy
+ * 		of the ADC results (ADC_OVERSAMPLE bursts when ADC_DMA = 1, identical
+ * 		unless set by HostSetAdcSum()), the ISR, then the GPIO SET/CLEAR/TOGGLE
+ * 		writes are folded into GPxDAT.
+ *
+ * 		HOST_CTRL is a controller instance apart from the one timer_isr() runs:
+ * 		its own CTRL_STATE and parameter set, stepped by the StepCtrlB2B() or
+ * 		StepCtrlNPC() of main.c on the ADC results it is given.  Instances share
+ * 		no writable state, so each thread of the gain sweep runs its own.
+ *
+ * 		ex:	HostSetRack(0);					//RK1B2B
+ * 			HostBoot();
+ * 			HostSetAinA(0, 2048);
+ * 			HostTick();
+ * 			cmp = HostGetCmpa(1);
+ *
+ * 			HOST_CTRL *c = HostCtrlNew(0);
+ * 			HostCtrlTick(c, adc, HOST_EN_AFE, cmp);
+ * 			HostCtrlFree(c);
+ * *****************************************************************************
+ */
+
+#ifndef ECI_HOST_H
+#define ECI_HOST_H
+
+#include <DSP2833x_Device.h>
+
+#define HOST_PWM_PD 3750			//PWM_PD of ECI_API.h, compare full scale.
+#define HOST_ISR_HZ 20000			//Control periods per second.
+#define HOST_ADC_OVERSAMPLE 4		//ADC_OVERSAMPLE of ECI_API.h (1 without ADC_DMA).
+#define HOST_ADC 16					//ADC results.
+#define HOST_PWM 6					//EPwm1-6
+
+#define HOST_EN_AFE 0x0001			//EN_x enables of main.c.
+#define HOST_EN_INV 0x0002
+#define HOST_EN_NPC 0x0004
+
+typedef struct HOST_CTRL HOST_CTRL;
+
+extern const Uint16 HostAinA[8];							//Result index of channel An, AIN_A().
+extern const Uint16 HostAinB[8];							//Result index of channel Bn, AIN_B().
+
+void HostBoot(void);										//InitBoard() of main.c, may be run again.
+void HostTick(void);										//One control period.
+
+void HostSetAdc(Uint16 k, Uint16 val);						//ADCRESULTk, 12-bit right aligned.
+void HostSetAdcSum(Uint16 k, Uint16 sum);					//ADCRESULTk, sum of HOST_ADC_OVERSAMPLE bursts.
+void HostSetAinA(Uint16 n, Uint16 val);						//Channel An, through AIN_A().
+void HostSetAinB(Uint16 n, Uint16 val);						//Channel Bn, through AIN_B().
+void HostSetGpio(Uint16 n, Uint16 level);					//GPIOn input level.
+void HostSetRack(Uint16 rack);								//DI jumpers for rack 0-3 (RK1B2B ... RK2NPC).
+void HostSetRackOtp(Uint16 id);								//OTP rack word RackIdOtp, 0xFFFF erased.
+void HostCanRx(Uint16 n, Uint32 mdl, Uint32 mdh);			//Message in mailbox n, runs its handler.
+Uint16 HostCanTx(Uint16 n, Uint32 *mdl, Uint32 *mdh);		//Message sent from mailbox n, 0 if none.
+void HostSetSkip(Uint16 skip);								//IsrSkip (DEGRADE_x) of the next HostTick().
+
+Uint16 HostGetCmpa(Uint16 m);								//EPwm m (1-6) CMPA.
+Uint16 HostGetCmpb(Uint16 m);								//EPwm m (1-6) CMPB.
+Uint16 HostGetGpio(Uint16 n);								//GPIOn level.
+Uint16 HostGetRack(void);									//Rack picked by SelectRack() at the last HostBoot().
+Uint16 HostGetMonitor(Uint16 ch, float32 *gain, float32 *offset, Uint16 *div);	//AO route ch in use, returns the signal.
+Uint32 HostCapture(const Uint16 **words);					//CapBuf (ECI_Capture.h), words recorded so far.
+
+HOST_CTRL *HostCtrlNew(Uint16 rack);						//Cleared instance with the default parameters, 0 if out of memory.
+void HostCtrlFree(HOST_CTRL *c);
+Uint16 HostCtrlSetParam(HOST_CTRL *c, Uint16 i, Uint32 val);	//Parameter i (PARAM_VAL.u), applied at once.  PARAM_OK or PARAM_ERR_x.
+Uint32 HostCtrlGetParam(const HOST_CTRL *c, Uint16 i);		//Parameter i, PARAM_VAL.u.
+void HostCtrlTick(HOST_CTRL *c, const Uint16 *adc, Uint16 enable, Uint16 *cmp);	//One ISR on the right aligned results adc[HOST_ADC], HOST_EN_x, cmp[HOST_PWM] out.
+Uint16 HostParamCount(void);								//PARAMS of main.c.
+
+#endif /*ECI_HOST_H*/
@@ -0,0 +1,100 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: eci_plant.h
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		Closed-loop converter plant around the host harness (eci_host.h).  One
+ * 		StepPlant() is one PWM period: the plant is integrated over the period
+ * 		with the compares of the last ISR, the ADC results are written with the
+ * 		scale factors of main.c, and HostTick() runs timer_isr() for the
+ * 		compares of the next period.
+ *
+ * 			B2B:	grid source, input inductor L, DC link Cdc, inverter LC
+ * 					filter (Lf, Cf) with a resistive or diode rectifier load.
+ * 			NPC:	grid source, input inductor L, split DC link C1/C2 with a
+ * 					resistive DC load.
+ *
+ * 		Each period is cut in PlantCfg.substeps steps.  A leg is not a 0/1 state
+ * 		inside a step but the exact fraction of the step its upper device is on
+ * 		(A output high while TBCTR < CMPA, up-down carrier), so volt-seconds are
+ * 		exact at any step count.  Dead time is not modelled.  The ADC results
+ * 		are the average of ADC_SAMPLES samples spread over the period, like
+ * 		ADC_DMA oversampling.
+ *
+ * 		A bridge whose enable GPIO is high (off) is a diode rectifier.  For the
+ * 		AFE it charges the DC link from the grid through r_diode, with the input
+ * 		inductors bypassed.  For the INV the filter inductor currents are held
+ * 		at zero.
+ *
+ * 		InitPlantModel() and StepPlantModel() are the plant alone, it takes the
+ * 		compares and enables and leaves the ADC results in adc[], for a HOST_CTRL
+ * 		instance (eci_host.h).  InitPlant() and StepPlant() run it around the
+ * 		harness and timer_isr().
+ *
+ * 		ex:	PLANT p;
+ * 			InitPlant(&p, &PlantDefault, 0);		//RK1B2B, boots main.c
+ * 			HostCanRx(1, 0x01000000, 0);			//AFE enable
+ * 			RunPlant(&p, 20000);					//1 s
+ * *****************************************************************************
+ */
+
+#ifndef ECI_PLANT_H
+#define ECI_PLANT_H
+
+#include <eci_host.h>
+
+#define PLANT_LOAD_R 0				//Star connected resistors R_load.
+#define PLANT_LOAD_DIODE 1			//Diode bridge into C_load || R_load.
+#define PLANT_ADC_SAMPLES 4			//ADC samples per period, evenly spread from TBCTR = 0.
+
+//Plant parameters.  Values not on the rack drawings are marked assumed.
+typedef struct
+{
+	double vg;						//Grid phase voltage peak [V].
+	double f;						//Grid frequency [Hz].
+	double L, r_L;					//Input inductor [H] and its resistance [ohm].
+	double Cdc;						//B2B DC link [F], assumed.
+	double r_bleed;					//DC link bleed resistor [ohm], assumed.
+	double Lf, r_Lf, Cf;			//INV filter [H, ohm, F], assumed.
+	Uint16 load;					//PLANT_LOAD_x, INV output.
+	double R_load;					//[ohm]
+	double C_load;					//Diode load capacitor [F].
+	double r_diode;					//Diode bridge on resistance [ohm].
+	double C1, C2;					//NPC upper and lower DC link [F], assumed.
+	double R_dc;					//NPC DC load [ohm].
+	Uint16 substeps;				//Integration steps per PWM period, multiple of 2*PLANT_ADC_SAMPLES.
+} PLANT_CFG;
+
+//Plant state, phase quantities a, b, c.
+typedef struct
+{
+	PLANT_CFG cfg;
+	Uint16 npc;						//Topology of the rack.
+	Uint32 ticks;					//PWM periods run.
+	double t;						//[s]
+	double vg[3];					//Grid voltage.
+	double ig[3];					//Grid current, into the converter.
+	double Vdc;						//B2B DC link, or vc1 + vc2.
+	double vc1, vc2;				//NPC upper and lower DC link.
+	double iL[3];					//INV filter inductor current.
+	double vcf[3];					//INV output (filter capacitor) voltage.
+	double vcl;						//Diode load capacitor.
+	Uint16 adc[HOST_ADC];			//ADC results for the next ISR, right aligned, by result index.
+} PLANT;
+
+extern const PLANT_CFG PlantDefault;
+
+void InitPlant(PLANT *p, const PLANT_CFG *cfg, Uint16 rack);	//Rack 0-3, DI jumpers set and HostBoot() run.
+void StepPlant(PLANT *p);										//One PWM period and the ISR at its end.
+void InitPlantModel(PLANT *p, const PLANT_CFG *cfg, Uint16 rack);	//InitPlant() without the harness.
+void StepPlantModel(PLANT *p, const Uint16 *cmpa, Uint16 on_r, Uint16 on_i);	//One PWM period on cmpa[HOST_PWM], bridges on or diode, no ISR.
+void RunPlant(PLANT *p, Uint32 ticks);
+
+#endif /*ECI_PLANT_H*/
@@ -0,0 +1,63 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: kernel_bench.h
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		Kernel table of the control-kernel microbenchmark (C++).  bench_kernels.inc
+ * 		is compiled twice from the API headers: in namespace BenchF with float32
+ * 		= float for the timing (kernel_bench.cpp), and in namespace BenchC with
+ * 		float32 = CountF for the op counts (bench_count.cpp, count_float.h).
+ *
+ * 		A kernel runs n calls on BenchIn[k & (BENCH_IN - 1)] and BenchPhase[]
+ * 		(columns in bench_kernels.inc), and stores each result to BenchOut[]
+ * 		through BENCH_SINK(), so nothing is optimized away.
+ * *****************************************************************************
+ */
+
+#ifndef KERNEL_BENCH_H
+#define KERNEL_BENCH_H
+
+#include <math.h>
+
+#define BENCH_IN 1024				//Input sets, a power of 2.
+#define BENCH_IN_COLS 8				//Values per input set.
+
+#define PWM_PD 3750.0f				//PWM_PD of ECI_API.h, as a float the way the compiler folds it.
+
+//One kernel variant.
+typedef struct
+{
+	const char *group;				//Kernel of timer_isr() it implements.
+	const char *name;
+	void (*run)(Uint32 n);			//n calls.
+} BENCH_KERNEL;
+
+extern float BenchIn[BENCH_IN][BENCH_IN_COLS];
+extern Uint32 BenchPhase[BENCH_IN];
+extern float BenchOut[BENCH_IN];
+
+#define BENCH_SINK(k, x) (BenchOut[(k) & (BENCH_IN - 1)] = RawValue(x))
+
+inline float RawValue(float x) {return x;}
+inline float SinD(float x) {return (float)sin((double)x);}	//double libm, the FLOAT32_MATH = 0 path
+inline float CosD(float x) {return (float)cos((double)x);}
+
+namespace BenchF
+{
+	extern const BENCH_KERNEL Kernels[];
+	extern const Uint16 KernelCount;
+}
+namespace BenchC
+{
+	extern const BENCH_KERNEL Kernels[];
+	extern const Uint16 KernelCount;
+}
+
+#endif /*KERNEL_BENCH_H*/
@@ -0,0 +1,71 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: sim_run.h
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		One closed-loop start up of a rack on the plant, with a parameter set
+ * 		checked like a CAN parameter write (ECI_Param.h), scored for the gain
+ * 		sweep (param_sweep.c).
+ *
+ * 		The run: diode precharge, parameters written and committed,
+ * 		AFE/NPC enabled at t_afe, INV at t_inv (B2B, t_inv < 0 leaves it off),
+ * 		stop at t_end.  Scores:
+ *
+ * 			settle		time from t_afe until Vdc stays within SIM_SETTLE_BAND
+ * 						of Vdcref [s], -1 if it never does.
+ * 			overshoot	largest Vdc above Vdcref after t_afe [% of Vdcref].
+ * 			thd			grid current phase a, harmonics 2-SIM_THD_HARMONICS over
+ * 						the last SIM_WINDOW [%].
+ * 			ripple		Vdc peak to peak over the last SIM_WINDOW [V].
+ *
+ * 		Each run steps its own HOST_CTRL instance (eci_host.h) on the plant
+ * 		model, not the ISR and globals of the harness, so runs are independent
+ * 		and SimRun() may be called from several threads at once.
+ * *****************************************************************************
+ */
+
+#ifndef SIM_RUN_H
+#define SIM_RUN_H
+
+#include <eci_host.h>
+
+#define SIM_PARAMS_MAX 32			//PARAM_MAX of ECI_Param.h.
+#define SIM_VDCREF_PARAM 12			//PARAM_VDCREF of main.c.
+#define SIM_SETTLE_BAND 0.02		//of Vdcref
+#define SIM_WINDOW 0.1				//[s], 6 grid cycles
+#define SIM_THD_HARMONICS 40
+#define SIM_GRID_HZ 60.0
+
+#define SIM_OK 0
+#define SIM_ERR_PARAM 1				//A parameter write was refused (index or range).
+#define SIM_ERR_UNSTABLE 2			//Vdc left [0 2*max(Vdcref, diode precharge)] or went NaN, run stopped.
+#define SIM_ERR_NOMEM 3				//No memory for the controller instance.
+
+//One run.
+typedef struct
+{
+	Uint16 rack;					//0-3
+	Uint16 diode_load;				//1: PLANT_LOAD_DIODE on the INV.
+	double t_afe, t_inv, t_end;		//[s]
+	Uint16 n;						//Parameters written.
+	Uint16 idx[SIM_PARAMS_MAX];		//Parameter numbers, PARAM_x of main.c.
+	float32 val[SIM_PARAMS_MAX];
+} SIM_RUN;
+
+typedef struct
+{
+	Uint16 status;					//SIM_OK or SIM_ERR_x
+	double settle, overshoot, thd, ripple;
+	double vdc;						//Vdc at t_end.
+} SIM_RESULT;
+
+void SimRun(const SIM_RUN *run, SIM_RESULT *res);
+
+#endif /*SIM_RUN_H*/
@@ -0,0 +1,46 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: ti_host.h
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		Forced include (gcc -include) for compiling the DSP sources on a PC.
+ * 		Maps the TI C28x keywords onto plain C so the unmodified main.c and
+ * 		ECI_API.h can be parsed by gcc/clang.
+ *
+ * 		The DSP28 data types are given their C28x widths here, ahead of
+ * 		DSP2833x_Device.h: Uint16 is 16 bits and Uint32 is 32 bits.  On a 64-bit
+ * 		host 'unsigned long' is 64 bits, which would split the .all/.bit register
+ * 		unions and the eCAN MDL/MDH bytes.
+ * *****************************************************************************
+ */
+
+#ifndef TI_HOST_H
+#define TI_HOST_H
+
+#define interrupt					//ISR qualifier, plain function on the host.
+#define cregister					//IER/IFR core registers, plain globals on the host.
+#define asm(x)						//EALLOW/EDIS/EINT/DINT/ESTOP0 inline assembly is dropped.
+
+#define main eci_main				//main.c's 'void main(void)' is not the host entry point.
+#define OTP_CONST					//OTP words (RackIdOtp) are RAM on the host, set by HostSetRackOtp().
+
+#include <stdint.h>
+
+#define DSP28_DATA_TYPES			//Skips the typedefs in DSP2833x_Device.h.
+typedef int16_t				int16;
+typedef int32_t				int32;
+typedef int64_t				int64;
+typedef uint16_t			Uint16;
+typedef uint32_t			Uint32;
+typedef uint64_t			Uint64;
+typedef float				float32;
+typedef double				float64;	//64-bit long double on the C28x.
+
+#endif /*TI_HOST_H*/
@@ -0,0 +1,152 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: kernel_bench.cpp
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		Microbenchmark of the timer_isr() kernels and their alternatives
+ * 		(bench_kernels.inc).
+ *
+ * 			./kernel_bench [-n calls] [-r repeats] [group]
+ *
+ * 		Per kernel: host ns per call (best of the repeats), and the float ops
+ * 		per call counted with CountF over BENCH_IN calls, with a weighted sum
+ * 		as a rough C28x cycle proxy.  The host time ranks kernels that do the
+ * 		same work differently, the op counts are what carries over to the
+ * 		target.  Neither replaces ECI_Profile.h on the F28335.
+ *
+ * 		Proxy weights: add, mul, cmp and cvt 2 cycles (FPU, no overlap assumed),
+ * 		div 20 (no hardware divide, RTS reciprocal and Newton steps), trig 40
+ * 		(FPU fastRTS sin/cos).  These are guesses, calibrate them against
+ * 		ECI_Profile.h before trusting the proxy across groups.
+ * *****************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <kernel_bench.h>
+#include <count_float.h>
+
+#undef main						//ti_host.h renames main.c's main(), this is the host one.
+
+#define W_ADD 2						//proxy cycles per op
+#define W_MUL 2
+#define W_CMP 2
+#define W_CVT 2
+#define W_DIV 20
+#define W_TRIG 40
+
+float BenchIn[BENCH_IN][BENCH_IN_COLS];
+Uint32 BenchPhase[BENCH_IN];
+float BenchOut[BENCH_IN];
+
+namespace BenchF
+{
+	#include "bench_kernels.inc"
+}
+
+//Rand(): xorshift32, the same inputs on every run.
+Uint32 Rand()
+{
+	static Uint32 x = 2463534242UL;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	return x;
+}
+
+//Uniform(): [lo hi)
+float Uniform(float lo, float hi)
+{
+	return lo + (hi - lo)*(float)(Rand() >> 8)*(1.0f/16777216.0f);
+}
+
+void FillInputs()
+{
+	Uint16 k, j;
+
+	for(k = 0; k < BENCH_IN; k++)
+	{
+		BenchPhase[k] = Rand();
+		BenchIn[k][0] = (float)(int32)BenchPhase[k]*1.462918e-9f;	//RAD_PER_PHASE
+		for(j = 1; j < BENCH_IN_COLS - 1; j++) BenchIn[k][j] = Uniform(-1.0f, 1.0f);
+		BenchIn[k][BENCH_IN_COLS - 1] = Uniform(0.0f, 400.0f);
+	}
+}
+
+double Now()
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec*1e9 + t.tv_nsec;
+}
+
+//TimeKernel(): Best ns per call over repeats runs of n calls.
+double TimeKernel(const BENCH_KERNEL *b, Uint32 n, int repeats)
+{
+	double best = 0.0, t;
+	int r;
+
+	b->run(n);							//warm up
+	for(r = 0; r < repeats; r++)
+	{
+		t = Now();
+		b->run(n);
+		t = Now() - t;
+		if(r == 0 || t < best) best = t;
+	}
+	return best/n;
+}
+
+int main(int argc, char **argv)
+{
+	Uint32 n = 65536;
+	int repeats = 5, a;
+	const char *group = 0;
+	const BENCH_KERNEL *b;
+	double ns, per = 1.0/BENCH_IN;
+	Uint16 k;
+
+	for(a = 1; a < argc; a++)
+	{
+		if(!strcmp(argv[a], "-n") && a + 1 < argc) n = strtoul(argv[++a], 0, 0);
+		else if(!strcmp(argv[a], "-r") && a + 1 < argc) repeats = atoi(argv[++a]);
+		else if(argv[a][0] != '-') group = argv[a];
+		else
+		{
+			fprintf(stderr, "usage: kernel_bench [-n calls] [-r repeats] [group]\n");
+			return 2;
+		}
+	}
+	if(n == 0) n = 1;
+	if(repeats < 1) repeats = 1;
+
+	FillInputs();
+	printf("#%lu calls, best of %d, ops per call, proxy = %d*(add+mul+cmp+cvt) + %d*div + %d*trig\n",
+		(unsigned long)n, repeats, W_ADD, W_DIV, W_TRIG);
+	printf("#%-8s %-24s %8s %6s %6s %6s %6s %6s %6s %7s\n", "group", "kernel", "ns", "add", "mul", "div", "cmp", "cvt", "trig", "proxy");
+	for(k = 0; k < BenchF::KernelCount; k++)
+	{
+		b = &BenchF::Kernels[k];
+		if(group && strcmp(group, b->group)) continue;
+		ns = TimeKernel(b, n, repeats);
+
+		ClearCountOps();
+		BenchC::Kernels[k].run(BENCH_IN);
+		printf(" %-8s %-24s %8.2f %6.2f %6.2f %6.2f %6.2f %6.2f %6.2f %7.1f\n", b->group, b->name, ns,
+			CountOps.add*per, CountOps.mul*per, CountOps.div*per, CountOps.cmp*per, CountOps.cvt*per, CountOps.trig*per,
+			(W_ADD*CountOps.add + W_MUL*CountOps.mul + W_CMP*CountOps.cmp + W_CVT*CountOps.cvt
+				+ W_DIV*CountOps.div + W_TRIG*CountOps.trig)*per);
+	}
+	return 0;
+}
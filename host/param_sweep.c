@@ -0,0 +1,258 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: param_sweep.c
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		Parallel gain/parameter sweep over the closed-loop plant simulation.
+ *
+ * 			./param_sweep [-j threads] [-n random_runs] [-s seed] [-r rack] [-T t_end]
+ * 						[-I t_inv] [-d] [-o file] name=lo:hi[:steps] ...
+ *
+ * 		Names are the parameters of main.c (kp_pll ... w_inv, see ParamName[]).
+ * 		Without -n the runs are the grid of every name's steps (default 5),
+ * 		with -n they are n uniform random draws in [lo hi].  Every run is one
+ * 		SimRun() (sim_run.h).
+ *
+ * 		Every run has its own controller instance (HOST_CTRL, eci_host.h) and
+ * 		plant, cleared at the start of the run, so runs share no state.
+ * 		Threads take the next run with an atomic increment and write their
+ * 		own result slot, no locks.  Results do not depend on -j.
+ *
+ * 		Output file (-o, default sweep.col), columnar, little endian:
+ * 			char magic[8] = "ECISWP01", uint32 rows, uint32 cols,
+ * 			cols x char name[16], then cols x rows float32, column by column.
+ * 		Columns: the swept parameters, settle, overshoot, thd, ripple, vdc,
+ * 		status (see sim_run.h).
+ * *****************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <sim_run.h>
+
+#undef main						//ti_host.h renames main.c's main(), this is the host one.
+
+#define SWEEP_RESULTS 6				//settle ... status
+#define NAME_LEN 16
+
+//Parameter names in PARAM_x order of main.c.
+const char *const ParamName[] =
+{
+	"kp_pll", "ki_pll", "kp_vdc", "ki_vdc", "kp_ird", "ki_ird", "kp_irq", "ki_irq",
+	"kp_vid", "ki_vid", "kp_viq", "ki_viq", "vdcref", "irqref", "L", "vidref", "viqref", "w_inv",
+};
+#define PARAM_NAMES (sizeof(ParamName)/sizeof(ParamName[0]))
+
+const char *const ResultName[SWEEP_RESULTS] = {"settle", "overshoot", "thd", "ripple", "vdc", "status"};
+
+//One swept parameter.
+typedef struct
+{
+	Uint16 idx;
+	double lo, hi;
+	Uint16 steps;
+} SWEEP_AXIS;
+
+SWEEP_AXIS Axis[SIM_PARAMS_MAX];
+Uint16 Axes;
+SIM_RUN *Runs;
+SIM_RESULT *Results;
+Uint32 RunCount;
+Uint32 NextRun;						//Taken with __atomic_fetch_add.
+
+//Worker(): Runs until none are left.
+void *Worker(void *arg)
+{
+	Uint32 i;
+
+	(void)arg;
+	while((i = __atomic_fetch_add(&NextRun, 1, __ATOMIC_RELAXED)) < RunCount)
+		SimRun(&Runs[i], &Results[i]);
+	return NULL;
+}
+
+//Rand01(): xorshift64*, uniform in [0 1).
+double Rand01(Uint64 *s)
+{
+	*s ^= *s >> 12;
+	*s ^= *s << 25;
+	*s ^= *s >> 27;
+	return (double)((*s * 0x2545F4914F6CDD1DULL) >> 11)*(1.0/9007199254740992.0);
+}
+
+//ParseAxis(): name=lo:hi[:steps]
+int ParseAxis(const char *arg, SWEEP_AXIS *a)
+{
+	const char *eq = strchr(arg, '=');
+	Uint16 k;
+	int steps = 5;
+
+	if(!eq) return 1;
+	for(k = 0; k < PARAM_NAMES; k++)
+		if(strlen(ParamName[k]) == (size_t)(eq - arg) && !strncmp(arg, ParamName[k], eq - arg)) break;
+	if(k == PARAM_NAMES || sscanf(eq + 1, "%lf:%lf:%d", &a->lo, &a->hi, &steps) < 2 || steps < 1) return 1;
+	a->idx = k;
+	a->steps = steps;
+	return 0;
+}
+
+//WriteColumns(): The columnar result file, see the header.
+int WriteColumns(const char *path)
+{
+	FILE *f = fopen(path, "wb");
+	Uint32 cols = Axes + SWEEP_RESULTS, c, i;
+	char name[NAME_LEN];
+	float *col = malloc(RunCount*sizeof(float));
+
+	if(!f || !col) return 1;
+	fwrite("ECISWP01", 1, 8, f);
+	fwrite(&RunCount, 4, 1, f);
+	fwrite(&cols, 4, 1, f);
+	for(c = 0; c < cols; c++)
+	{
+		memset(name, 0, sizeof(name));
+		strncpy(name, (c < Axes) ? ParamName[Axis[c].idx] : ResultName[c - Axes], NAME_LEN - 1);
+		fwrite(name, 1, NAME_LEN, f);
+	}
+	for(c = 0; c < cols; c++)
+	{
+		for(i = 0; i < RunCount; i++)
+		{
+			const SIM_RESULT *r = &Results[i];
+
+			switch((c < Axes) ? -1 : (int)(c - Axes))
+			{
+			case -1:	col[i] = Runs[i].val[c];	break;
+			case 0:		col[i] = r->settle;			break;
+			case 1:		col[i] = r->overshoot;		break;
+			case 2:		col[i] = r->thd;			break;
+			case 3:		col[i] = r->ripple;			break;
+			case 4:		col[i] = r->vdc;			break;
+			default:	col[i] = r->status;			break;
+			}
+		}
+		fwrite(col, sizeof(float), RunCount, f);
+	}
+	free(col);
+	return fclose(f) != 0;
+}
+
+int main(int argc, char **argv)
+{
+	SIM_RUN base;
+	const char *out = "sweep.col";
+	Uint32 threads = sysconf(_SC_NPROCESSORS_ONLN), random_runs = 0, i, k, best;
+	Uint64 seed = 1;
+	pthread_t *tid;
+	struct timespec t0, t1;
+	double wall;
+	int opt;
+
+	memset(&base, 0, sizeof(base));
+	base.t_afe = 0.05;
+	base.t_inv = -1.0;
+	base.t_end = 0.6;
+
+	while((opt = getopt(argc, argv, "j:n:s:r:T:I:do:")) != -1)
+	{
+		switch(opt)
+		{
+		case 'j':	threads = atoi(optarg);		break;
+		case 'n':	random_runs = atoi(optarg);	break;
+		case 's':	seed = strtoull(optarg, NULL, 0) | 1;	break;
+		case 'r':	base.rack = atoi(optarg) & 3;	break;
+		case 'T':	base.t_end = atof(optarg);	break;
+		case 'I':	base.t_inv = atof(optarg);	break;
+		case 'd':	base.diode_load = 1;		break;
+		case 'o':	out = optarg;				break;
+		default:	return 2;
+		}
+	}
+	for(; optind < argc && Axes < SIM_PARAMS_MAX; optind++)
+	{
+		if(ParseAxis(argv[optind], &Axis[Axes]))
+		{
+			fprintf(stderr, "param_sweep: bad axis '%s', name=lo:hi[:steps]\n", argv[optind]);
+			return 2;
+		}
+		Axes++;
+	}
+	if(base.t_end < base.t_afe + SIM_WINDOW) base.t_end = base.t_afe + SIM_WINDOW;
+	if(threads < 1) threads = 1;
+
+	if(HostParamCount() != PARAM_NAMES)						//ParamName[] is in step with main.c
+	{
+		fprintf(stderr, "param_sweep: main.c has %u parameters, ParamName[] has %u\n", HostParamCount(), (unsigned)PARAM_NAMES);
+		return 2;
+	}
+
+	RunCount = 1;
+	if(random_runs) RunCount = random_runs;
+	else for(k = 0; k < Axes; k++) RunCount *= Axis[k].steps;
+	Runs = calloc(RunCount, sizeof(SIM_RUN));
+	Results = calloc(RunCount, sizeof(SIM_RESULT));
+	tid = calloc(threads, sizeof(pthread_t));
+	if(!Runs || !Results || !tid) return 2;
+
+	for(i = 0; i < RunCount; i++)
+	{
+		Uint32 rest = i;
+
+		Runs[i] = base;
+		Runs[i].n = Axes;
+		for(k = 0; k < Axes; k++)
+		{
+			const SWEEP_AXIS *a = &Axis[k];
+			double x;
+
+			if(random_runs) x = Rand01(&seed);
+			else
+			{
+				x = (a->steps > 1) ? (double)(rest % a->steps)/(a->steps - 1) : 0.0;
+				rest /= a->steps;
+			}
+			Runs[i].idx[k] = a->idx;
+			Runs[i].val[k] = a->lo + x*(a->hi - a->lo);
+		}
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for(k = 0; k < threads; k++) pthread_create(&tid[k], NULL, Worker, NULL);
+	for(k = 0; k < threads; k++) pthread_join(tid[k], NULL);
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	wall = (t1.tv_sec - t0.tv_sec) + 1e-9*(t1.tv_nsec - t0.tv_nsec);
+
+	if(WriteColumns(out))
+	{
+		fprintf(stderr, "param_sweep: cannot write %s\n", out);
+		return 2;
+	}
+	printf("%u runs of %.2f s on %u threads in %.1f s (%.1f runs/s), %s\n",
+		RunCount, base.t_end, threads, wall, RunCount/wall, out);
+
+	best = RunCount;
+	for(i = 0; i < RunCount; i++)
+		if(Results[i].status == SIM_OK && Results[i].settle >= 0.0 &&
+			(best == RunCount || Results[i].settle < Results[best].settle)) best = i;
+	if(best == RunCount)
+	{
+		printf("no run settled\n");
+		return 1;
+	}
+	printf("fastest settle: run %u,", best);
+	for(k = 0; k < Axes; k++) printf(" %s=%g", ParamName[Axis[k].idx], Runs[best].val[k]);
+	printf(": settle %.3f s, overshoot %.1f %%, thd %.2f %%, ripple %.2f V\n",
+		Results[best].settle, Results[best].overshoot, Results[best].thd, Results[best].ripple);
+	return 0;
+}
@@ -0,0 +1,86 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: plant_sim.c
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		Closed-loop start up of one rack on the plant of eci_plant.c.
+ *
+ * 			./plant_sim [rack 0-3] [seconds] [diode]
+ *
+ * 		The DC link sits on the diode precharge for 50 ms, then the AFE (or NPC)
+ * 		is enabled over CAN, and the INV at 0.3 s on a B2B rack.  Prints one line
+ * 		per 20 ms, and the simulated time per second of wall time.  Exits 1 if
+ * 		the DC link is not within VDC_TOL of Vdcref at the end.
+ * *****************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <eci_plant.h>
+
+#undef main						//ti_host.h renames main.c's main(), this is the host one.
+
+#define VDCREF 360.0				//PARAM_VDCREF default of main.c
+#define VDC_TOL 5.0
+#define T_AFE 0.05					//AFE enable [s]
+#define T_INV 0.3					//INV enable [s]
+#define T_LOG 0.02
+
+//PeakOf(): Largest magnitude of x[0..2].
+double PeakOf(const double x[3])
+{
+	double m = fabs(x[0]);
+
+	if(fabs(x[1]) > m) m = fabs(x[1]);
+	if(fabs(x[2]) > m) m = fabs(x[2]);
+	return m;
+}
+
+int main(int argc, char **argv)
+{
+	Uint16 rack = (argc > 1) ? atoi(argv[1]) : 0;
+	double seconds = (argc > 2) ? atof(argv[2]) : 1.0;
+	PLANT_CFG cfg = PlantDefault;
+	PLANT p;
+	Uint32 ticks, t_afe = T_AFE*HOST_ISR_HZ, t_inv = T_INV*HOST_ISR_HZ, t_log = T_LOG*HOST_ISR_HZ;
+	double ig = 0.0, vo = 0.0, wall;
+	clock_t start;
+
+	if(argc > 3) cfg.load = PLANT_LOAD_DIODE;
+	ticks = seconds*HOST_ISR_HZ;
+	InitPlant(&p, &cfg, rack & 3);
+	printf("#rack %u, %s\n#t[s]\tVdc[V]\tdVnp[V]\tig[A]\tvo[V]\n", rack & 3, p.npc ? "NPC" : "B2B");
+
+	start = clock();
+	while(p.ticks < ticks)
+	{
+		if(p.ticks == t_afe) HostCanRx(1, 0x01000000, 0);		//ENABLE_MBOX
+		if(p.ticks == t_inv && !p.npc) HostCanRx(2, 0x01000000, 0);	//INV_MBOX
+		StepPlant(&p);
+		if(PeakOf(p.ig) > ig) ig = PeakOf(p.ig);
+		if(PeakOf(p.vcf) > vo) vo = PeakOf(p.vcf);
+		if(p.ticks % t_log == 0)
+		{
+			printf("%.3f\t%.1f\t%.1f\t%.1f\t%.1f\n", p.t, p.Vdc, p.npc ? p.vc1 - p.vc2 : 0.0, ig, vo);
+			ig = vo = 0.0;
+		}
+	}
+	wall = (double)(clock() - start)/CLOCKS_PER_SEC;
+	printf("#%.2f s simulated in %.2f s, %.1f x real time\n", p.t, wall, p.t/wall);
+
+	if(fabs(p.Vdc - VDCREF) > VDC_TOL)
+	{
+		printf("FAIL: Vdc %.1f V, Vdcref %.0f V\n", p.Vdc, VDCREF);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,116 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: sim_run.c
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		One scored start up, see include/sim_run.h.
+ * *****************************************************************************
+ */
+
+#include <math.h>
+#include <string.h>
+#include <eci_plant.h>
+#include <sim_run.h>
+
+#define PI_D 3.14159265358979
+
+//SimStep(): One PWM period of p and the ISR of c at its end, the compares kept in cmp[].
+static void SimStep(PLANT *p, HOST_CTRL *c, Uint16 enable, Uint16 *cmp)
+{
+	Uint16 on_r = (enable & (HOST_EN_AFE | HOST_EN_NPC)) != 0;
+	Uint16 on_i = (enable & (HOST_EN_INV | HOST_EN_NPC)) != 0;
+
+	StepPlantModel(p, cmp, on_r, on_i);
+	HostCtrlTick(c, p->adc, enable, cmp);
+}
+
+void SimRun(const SIM_RUN *run, SIM_RESULT *res)
+{
+	PLANT_CFG cfg = PlantDefault;
+	PLANT p;
+	HOST_CTRL *c;
+	union {float32 f; Uint32 u;} v;
+	Uint32 t_afe = run->t_afe*HOST_ISR_HZ;
+	Uint32 t_inv = (run->t_inv < 0.0) ? 0xFFFFFFFF : (Uint32)(run->t_inv*HOST_ISR_HZ);
+	Uint32 t_end = run->t_end*HOST_ISR_HZ;
+	Uint32 t_win = t_end - (Uint32)(SIM_WINDOW*HOST_ISR_HZ);
+	Uint32 t_out = 0;
+	double re[SIM_THD_HARMONICS + 1], im[SIM_THD_HARMONICS + 1];
+	double vdcref, band, vdc_lim, vmin = 1e9, vmax = -1e9, h2 = 0.0, w;
+	Uint16 cmp[HOST_PWM], h, k, enable = 0;
+
+	memset(res, 0, sizeof(*res));
+	memset(re, 0, sizeof(re));
+	memset(im, 0, sizeof(im));
+	memset(cmp, 0, sizeof(cmp));
+	if(run->diode_load) cfg.load = PLANT_LOAD_DIODE;
+	c = HostCtrlNew(run->rack);
+	if(!c)
+	{
+		res->status = SIM_ERR_NOMEM;
+		return;
+	}
+	InitPlantModel(&p, &cfg, run->rack);
+
+	for(k = 0; k < run->n; k++)
+	{
+		v.f = run->val[k];
+		if(HostCtrlSetParam(c, run->idx[k], v.u) != 0) res->status = SIM_ERR_PARAM;
+	}
+	if(res->status != SIM_OK)
+	{
+		HostCtrlFree(c);
+		return;
+	}
+	SimStep(&p, c, enable, cmp);								//the commit tick of a run on the target
+	v.u = HostCtrlGetParam(c, SIM_VDCREF_PARAM);
+	vdcref = v.f;
+	band = SIM_SETTLE_BAND*vdcref;
+	vdc_lim = 2*fmax(vdcref, sqrt(3.0)*cfg.vg);				//precharge reaches the line to line peak
+
+	while(p.ticks < t_end)
+	{
+		if(p.ticks >= t_afe)									//>=, the commit tick is already past t_afe = 0
+			enable |= p.npc ? HOST_EN_NPC : HOST_EN_AFE;
+		if(p.ticks >= t_inv && !p.npc)
+			enable |= HOST_EN_INV;
+		SimStep(&p, c, enable, cmp);
+
+		if(!(p.Vdc > 0.0 && p.Vdc < vdc_lim))					//also NaN
+		{
+			res->status = SIM_ERR_UNSTABLE;
+			break;
+		}
+		if(p.ticks > t_afe)
+		{
+			if(fabs(p.Vdc - vdcref) > band) t_out = p.ticks;
+			if(p.Vdc - vdcref > res->overshoot) res->overshoot = p.Vdc - vdcref;
+		}
+		if(p.ticks > t_win)
+		{
+			if(p.Vdc < vmin) vmin = p.Vdc;
+			if(p.Vdc > vmax) vmax = p.Vdc;
+			for(h = 1; h <= SIM_THD_HARMONICS; h++)
+			{
+				w = 2*PI_D*SIM_GRID_HZ*h*p.t;
+				re[h] += p.ig[0]*cos(w);
+				im[h] += p.ig[0]*sin(w);
+			}
+		}
+	}
+
+	HostCtrlFree(c);
+	res->vdc = p.Vdc;
+	res->overshoot *= 100.0/vdcref;
+	res->settle = (t_out + 1 >= p.ticks) ? -1.0 : (double)(t_out > t_afe ? t_out - t_afe : 0)/HOST_ISR_HZ;
+	res->ripple = vmax - vmin;
+	for(h = 2; h <= SIM_THD_HARMONICS; h++) h2 += re[h]*re[h] + im[h]*im[h];
+	res->thd = 100.0*sqrt(h2/(re[1]*re[1] + im[1]*im[1] + 1e-30));
+}
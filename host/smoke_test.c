@@ -0,0 +1,162 @@
+/* DSP Controller Project
+ * Energy Conversion and Integration Group
+ * Center for Advanced Power Systems
+ * Florida State University
+ * ******************************************************************************
+ *
+ * Filename: smoke_test.c
+ *
+ * Last Modified: October 17, 2026
+ *
+ * ******************************************************************************
+ * Purpose:
+ * 		Smoke test of the host build (make -C host test).  Boots a B2B and an NPC
+ * 		rack on a balanced 60 Hz grid, enables them over CAN and runs 0.1 s of
+ * 		control periods.  Checks the compares stay in [0 PWM_PD] and move, the
+ * 		enable GPIOs follow CAN, and a second run gives the same compares.  The
+ * 		compare checksum is printed, to compare a change against the baseline.
+ * 		Also checks SelectRack() takes the OTP rack word over the jumpers.
+ * *****************************************************************************
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <eci_host.h>
+
+#undef main						//ti_host.h renames main.c's main(), this is the host one.
+
+#define TICKS 2000					//0.1 s
+#define GRID_COUNTS 700.0f			//~120 V phase peak at 0.1705 V per count
+#define VDC_COUNTS 1489				//~400 V at 0.2687 V per count
+
+#define PWM_R_GPIO 34				//Gate driver enables, active low.
+#define PWM_I_GPIO 35
+#define DO10_GPIO 52
+
+Uint16 Failures;
+
+void Check(int ok, const char *what)
+{
+	if(ok) return;
+	printf("FAIL: %s\n", what);
+	Failures++;
+}
+
+//SetGrid(): Balanced grid at tick t on the three channels of v, mid scale currents.
+void SetGrid(Uint16 t, Uint16 npc)
+{
+	float32 th = 2.0f*3.14159265f*60.0f*t/HOST_ISR_HZ;
+	float32 va = GRID_COUNTS*sinf(th);
+	float32 vb = GRID_COUNTS*sinf(th - 2.0943951f);
+	float32 vc = GRID_COUNTS*sinf(th + 2.0943951f);
+
+	HostSetAinB(2, 2048);
+	HostSetAinB(3, 2048);
+	HostSetAinB(4, 2048);
+	if(npc)
+	{
+		HostSetAinB(0, (Uint16)(2048.0f + 0.5f*(va - vb)));	//line to line, within the ADC span
+		HostSetAinB(1, (Uint16)(2048.0f + 0.5f*(vb - vc)));
+		HostSetAinA(0, 2048 + VDC_COUNTS/2);					//split DC link, balanced
+		HostSetAinA(1, 2048 + VDC_COUNTS/2);
+	}
+	else
+	{
+		HostSetAinB(0, (Uint16)(2048.0f + va));
+		HostSetAinB(1, (Uint16)(2048.0f + vb));
+		HostSetAinB(6, (Uint16)(2048.0f + vc));
+		HostSetAinB(5, 2048 + VDC_COUNTS);
+		HostSetAinA(0, 2048);
+		HostSetAinA(1, 2048);
+		HostSetAinA(6, 2048);
+	}
+}
+
+//RunRack(): Boots rack (0-3), enables it and returns the compare checksum of TICKS periods.
+Uint32 RunRack(Uint16 rack)
+{
+	Uint16 npc = rack >= 2;
+	Uint16 t, m, cmp, lo = HOST_PWM_PD, hi = 0;
+	Uint32 sum = 0;
+
+	HostSetRack(rack);
+	HostBoot();
+	Check(HostGetGpio(PWM_R_GPIO) == 1 && HostGetGpio(PWM_I_GPIO) == 1, "PWM disabled after boot");
+
+	HostCanRx(1, 0x01000000, 0);							//ENABLE_MBOX, byte 0 = 1
+	if(!npc) HostCanRx(2, 0x01000000, 0);					//INV_MBOX
+	Check(HostGetGpio(PWM_R_GPIO) == 0 && HostGetGpio(PWM_I_GPIO) == 0, "PWM enabled over CAN");
+
+	for(t = 0; t < TICKS; t++)
+	{
+		SetGrid(t, npc);
+		HostTick();
+		for(m = 1; m <= 6; m++)
+		{
+			cmp = HostGetCmpa(m);
+			if(cmp < lo) lo = cmp;
+			if(cmp > hi) hi = cmp;
+			sum = sum*31 + cmp;
+		}
+	}
+	Check(hi <= HOST_PWM_PD, "compares within PWM_PD");
+	Check(hi > lo, "compares move");
+	Check(HostGetGpio(DO10_GPIO) == 0, "DO10 cleared at the end of the ISR");
+
+	HostCanRx(1, 0x00000000, 0);
+	Check(HostGetGpio(PWM_R_GPIO) == 1, "PWM disabled over CAN");
+	return sum;
+}
+
+//CheckRackOtp(): A programmed OTP rack word wins over the jumpers, an erased or bad one falls back to them.
+void CheckRackOtp(void)
+{
+	HostSetRack(0);
+	HostSetRackOtp(2);
+	HostBoot();
+	Check(HostGetRack() == 2, "rack from the OTP word");
+	HostSetRack(1);
+	HostSetRackOtp(3);
+	HostBoot();
+	Check(HostGetRack() == 3, "OTP word over the jumpers");
+	HostSetRackOtp(7);
+	HostBoot();
+	Check(HostGetRack() == 1, "jumpers for an OTP word out of range");
+	HostSetRackOtp(0xFFFF);
+	HostBoot();
+	Check(HostGetRack() == 1, "jumpers for an erased OTP word");
+}
+
+//CheckMonitorCan(): A monitor route over CAN keeps a gain of a few mV per unit exactly.
+void CheckMonitorCan(void)
+{
+	union {float32 f; Uint32 u;} g;
+	float32 gain, offset;
+	Uint16 div, sig;
+
+	HostSetRack(0);
+	HostBoot();
+	HostTick();												//takes over the default routes
+	g.f = 3.0f/(4096.0f*0.2687f);							//MON_GAIN_ADC(0.2687), 2.7 mV per V
+	HostCanRx(3, ((Uint32)((2 << 5) | 6) << 24) | (10UL << 16) | (Uint16)-150, g.u);	//MON_MBOX: AO3 = Vdc, div 10, -1.5 V
+	HostTick();
+	sig = HostGetMonitor(2, &gain, &offset, &div);
+	Check(sig == 6 && div == 10 && gain == g.f && offset > -1.5001f && offset < -1.4999f, "monitor route over CAN");
+}
+
+int main(void)
+{
+	Uint16 rack;
+	Uint32 sum;
+
+	CheckRackOtp();
+	CheckMonitorCan();
+	for(rack = 0; rack < 4; rack += 2)
+	{
+		sum = RunRack(rack);
+		Check(RunRack(rack) == sum, "same compares on a second run");
+		printf("rack %u: compare checksum %08lx\n", rack, (unsigned long)sum);
+	}
+	printf("%s (%u failures)\n", Failures ? "FAILED" : "passed", Failures);
+	return Failures != 0;
+}
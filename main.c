@@ -21,10 +21,7 @@
  */
 
 
-#define RK1B2B
-//#define RK2B2B
-//#define RK1NPC
-//#define RK2NPC
+//The rack (RK1B2B, RK2B2B, RK1NPC, RK2NPC) is picked at boot, see RackProfile[] and SelectRack().
 
 
 /*
@@ -92,913 +89,917 @@
 
 
 #include <ECI_API.h>
-#include <cmath>
-
-#define PI 3.14159
-
-void SetAll_AO(float32 *V)
-{
-    Uint16 DacVal[4];
-    static Uint16 DacAddys[] = { DAC1, DAC2, DAC3, DAC4 };
-    static Uint16 DacSettings[] = {0x30, 0x30, 0x30, 0x20};
-
-    int i = 0;
-
-    for(i = 0; i < 4; i++)
-    {
-        DacVal[i] = (Uint16) (255*V[i])/3;              //Convert for [0 3] to [0 255].
-        if(DacVal[i] > 255) DacVal[i] = 255;                //For error checking, Vout = [0 3].
-
-        if(i != 0)
-        {
-            //This function does not return until the I2C is finished transmitting and the bus is free.
-            while(I2caRegs.I2CMDR.bit.STP == 1);
-            while(I2caRegs.I2CSTR.bit.BB == 1);
-        }
-                                        //We will send 3 bytes to DAC.
-        //Send first set of bytes
-        I2caRegs.I2CDXR = DacAddys[i];                          //We are sending data to DAC1.
-        I2caRegs.I2CDXR = (DacVal[i] >> 4) | (DacSettings[i]);  //First byte: [ PD1 | PD0 |CLR_L|LDAC_L| D7 | D6 | D5 | D4 ]
-        I2caRegs.I2CDXR = (DacVal[i] & 0xF) << 4;               //Second byte:[ D3 | D2 | D1 | D0 | 0 | 0 | 0 | 0 ]
-
-        I2caRegs.I2CCNT = 3;
-        I2caRegs.I2CMDR.bit.TRX = 0x1;                          //Transmit mode.
-        I2caRegs.I2CMDR.bit.FREE = 0x1;                         //Free run during breakpoint.
-        I2caRegs.I2CMDR.bit.MST = 0x1;                          //Master mode.
-        I2caRegs.I2CMDR.bit.STP = 0x1;                          //Stop bit.
-        I2caRegs.I2CMDR.bit.STT = 0x1;                          //Start transmission.
-
-        if(i == 0)
-        {
-            //This function does not return until the I2C is finished transmitting and the bus is free.
-            while(I2caRegs.I2CMDR.bit.STP == 1);
-            while(I2caRegs.I2CSTR.bit.BB == 1);
-        }
-    }
-}
+#include <math.h>
+#include <string.h>
+#include <ECI_Trig.h>
+#include <ECI_PI.h>
+#include <ECI_Transform.h>
+#include <ECI_Modulation.h>
+#include <ECI_Npc.h>
+#include <ECI_Trace.h>
+#include <ECI_Monitor.h>
+
+#define PI 3.14159f
 
 //////////////////////////////////Beginning of Jesse's added variables 8/27/2013//////////////////////////
 
-volatile float32 T = 0.00005;   //sample time = 1/10k = 0.0001 for 10kHz ISR (and fsw)
-int AFEenable = 0;
-int INVenable = 0;
-int NPCenable = 0;
-
-//debugging variables
-volatile float32 vabuff[167];
-volatile float32 vbbuff[167];
-volatile float32 vcbuff[167];
-volatile float32 vdcbuff[167];
-volatile float32 iabuff[167];
-volatile float32 ibbuff[167];
-volatile float32 icbuff[167];
-int buffidx = 0;
-
-//INV voltage references from RTDS
-volatile float32 viaref_rtds;
-volatile float32 vibref_rtds;
-volatile float32 vicref_rtds;
-
-//NPC variables
-volatile float32 deltaVnp;
-volatile float32 sector;
-volatile float32 vz_npc;
-
-//variables for input
-volatile float32 Vdc;
-volatile float32 vab, vbc;
-volatile float32 ia, ib, ic;
-volatile float32 va, vb, vc;
-volatile float32 vrd;
-volatile float32 vrq;
-volatile float32 ird;
-volatile float32 irq;
-
-//PLL variables
-volatile float32 theta_vin = 0;
-volatile float32 theta_vinn1 = 0;
-volatile float32 omega_pll = 0;
-volatile float32 omega_plln1 = 0;
-volatile float32 ki_pll = 500;
-volatile float32 kp_pll = 10;
-volatile float32 vrqn1 = 0;
-
-//for Vdc PI control, output is idref
-volatile float32 Vdcref = 360; // ***********set Vdc reference here**************
-
-volatile float32 irdref = 0;  //input current, i, of rectifier, r, for d axis
-volatile float32 irdrefn1 = 0; //idref one delay in the past
-volatile float32 e_vdc = 0;
-volatile float32 e_vdcn1 = 0;
-
-volatile float32 ki_vdc = 10;
-volatile float32 kp_vdc = 0.2;
-
-//for id, iq PI control
-volatile float32 irqref = 0.0;  //input current, i, of rectifier, r, for q axis
-
-volatile float32 u_ird = 0;
-volatile float32 u_irq = 0;
-volatile float32 u_irdn1 = 0;
-volatile float32 u_irqn1 = 0;
-volatile float32 e_ird = 0;
-volatile float32 e_irq = 0;
-volatile float32 e_irdn1 = 0;
-volatile float32 e_irqn1 = 0;
-volatile float32 vrdref = 0;
-volatile float32 vrqref = 0;
-volatile float32 vraref = 0;
-volatile float32 vrbref = 0;
-volatile float32 vrcref = 0;
-
-volatile float32 ki_ird = 50;
-volatile float32 ki_irq = 50;
-volatile float32 kp_ird = 5;
-volatile float32 kp_irq = 5;
-
-volatile float32 L=0.0012; //input inductor value for decoupling
-
-volatile float32 dra,drb,drc; //rectifier pwm duty cycles
-volatile float32 time = 0;
+volatile float32 T = 0.00005f;   //sample time = 1/10k = 0.0001 for 10kHz ISR (and fsw)
+volatile int AFEenable = 0;		//written by the CAN receive handlers, which may preempt timer_isr()
+volatile int INVenable = 0;
+volatile int NPCenable = 0;
 
 //////////////////////////////////END OF Jesse's added variables 8/27/2013//////////////////////////
 
-// INV closed loop variables - JPL 9/10/2013
-volatile float32 via = 0;
-volatile float32 vib = 0;
-volatile float32 vic = 0;
-
-volatile float32 theta_vout = 0;
-volatile float32 w_inv = 377;
-
-volatile float32 dia = 0;
-volatile float32 dib = 0;
-volatile float32 dic = 0;
-volatile float32 viaref = 0;
-volatile float32 vibref = 0;
-volatile float32 vicref = 0;
-volatile float32 vid = 0;
-volatile float32 viq = 0;
-volatile float32 vidref = 170;  // OUTPUT VOLTAGE Vd REF FOR INV HERE *******
-volatile float32 viqref = 0;
-volatile float32 kp_vid = 0.1;
-volatile float32 kp_viq = 0.1;
-volatile float32 ki_vid = 10;
-volatile float32 ki_viq = 10;
-
-volatile float32 u_vid = 0;    //for output voltage PI of INV
-volatile float32 u_viq = 0;    //for output voltage PI of INV
-volatile float32 u_vidn1 = 0;  //for output voltage PI of INV
-volatile float32 u_viqn1 = 0;  //for output voltage PI of INV
-volatile float32 e_vid = 0;    //for output voltage PI of INV
-volatile float32 e_viq = 0;    //for output voltage PI of INV
-volatile float32 e_vidn1 = 0;  //for output voltage PI of INV
-volatile float32 e_viqn1 = 0;  //for output voltage PI of INV
-//end of variables added 9/10/13
-
-
-
-
-
-volatile Uint16 t = 0x0;
-volatile float32 A = 0;
-volatile float32 B = 0;
-volatile float32 C = 0;
-
-volatile float32 Ph = 0;
-volatile float32 Phn1 = 0;
-volatile float32 EPh = 0;
-volatile float32 Vp = 0;
-volatile float32 UVpn1 = 0;
-volatile float32 UVpsn1 = 0;
-volatile float32 UVpcn1 = 0;
-volatile float32 Vr = 0;
-volatile float32 UVrn1 = 0;
-volatile float32 EVrn1 = 0;
-volatile float32 UrAn = 7440.5;
-volatile float32 UrBn = 7440.5;
-volatile float32 UrCn = 7440.5;
-
-volatile float32 Vi = 0;
-volatile float32 EVi1n1 = 0;
-volatile float32 EVi1n2 = 0;
-volatile float32 UVi1n1 = 0;
-volatile float32 UVi1n2 = 0;
-volatile float32 EVi2n1 = 0;
-volatile float32 EVi2n2 = 0;
-volatile float32 UVi2n1 = 0;
-volatile float32 UVi2n2 = 0;
-volatile float32 UiAn = 7440.5;
-volatile float32 UiBn = 7440.5;
-volatile float32 UiCn = 7440.5;
-//volatile float32 Vdcref = 70 ;
-volatile float32 Vpi = 14.3; //28.57738 ;
+//Enables latched at ISR entry, before CAN receive may preempt, so the control step and the
+//capture of one tick see the same enables.
+#define EN_AFE 0x0001			//AFEenable == 1
+#define EN_INV 0x0002			//INVenable == 1
+#define EN_NPC 0x0004			//NPCenable == 1
+#if(EN_AFE != CAP_F_AFE || EN_INV != CAP_F_INV || EN_NPC != CAP_F_NPC)
+	#error "EN_x must match the CAP_F_x capture flags."
+#endif
+Uint16 IsrEnable;
+
+/////////////////////////////////////////PARAMETERS///////////////////////////////////////////
+//Gains and setpoints, changed at runtime over CAN (see ECI_Param.h).  From the debugger, write
+//ParamStaging() and set ParamCommit.  The defaults are the values that used to be compiled in.
+/////////////////////////////////////////PARAMETERS///////////////////////////////////////////
+#define PARAM_KP_PLL 0
+#define PARAM_KI_PLL 1
+#define PARAM_KP_VDC 2			//for Vdc PI control, output is idref
+#define PARAM_KI_VDC 3
+#define PARAM_KP_IRD 4			//for id, iq PI control
+#define PARAM_KI_IRD 5
+#define PARAM_KP_IRQ 6
+#define PARAM_KI_IRQ 7
+#define PARAM_KP_VID 8			//INV closed loop gains - JPL 9/10/2013
+#define PARAM_KI_VID 9
+#define PARAM_KP_VIQ 10
+#define PARAM_KI_VIQ 11
+#define PARAM_VDCREF 12			//DC link voltage reference [V]
+#define PARAM_IRQREF 13			//rectifier q axis current reference [A]
+#define PARAM_L 14				//input filter inductance for the decoupling [H]
+#define PARAM_VIDREF 15			//INV output d axis voltage, end of the ramp [V]
+#define PARAM_VIQREF 16			//INV output q axis voltage [V]
+#define PARAM_W_INV 17			//INV output frequency [rad/s]
+#define PARAMS 18
+
+const PARAM_DEF ParamDef[PARAMS] =
+{
+	//type		default	min		max
+	{PARAM_F32,	10,		0,		1000},		//kp_pll
+	{PARAM_F32,	500,	0,		10000},		//ki_pll
+	{PARAM_F32,	0.2f,	0,		10},		//kp_vdc
+	{PARAM_F32,	10,		0,		1000},		//ki_vdc
+	{PARAM_F32,	5,		0,		100},		//kp_ird
+	{PARAM_F32,	50,		0,		10000},		//ki_ird
+	{PARAM_F32,	5,		0,		100},		//kp_irq
+	{PARAM_F32,	50,		0,		10000},		//ki_irq
+	{PARAM_F32,	0.1f,	0,		10},		//kp_vid
+	{PARAM_F32,	10,		0,		1000},		//ki_vid
+	{PARAM_F32,	0.1f,	0,		10},		//kp_viq
+	{PARAM_F32,	10,		0,		1000},		//ki_viq
+	{PARAM_F32,	360,	0,		800},		//Vdcref
+	{PARAM_F32,	0,		-30,	30},		//irqref
+	{PARAM_F32,	0.0012f, 0,		0.1f},		//L
+	{PARAM_F32,	170,	0,		400},		//vidref
+	{PARAM_F32,	0,		-400,	400},		//viqref
+	{PARAM_F32,	377,	0,		1000},		//w_inv
+};
+
+/////////////////////////////////////////CONTROLLER STATE///////////////////////////////////////////
+//One non-volatile state struct per converter, placed in the 'ctrlstate' section (RAML4).
+//The step functions load what they need into locals, compute, and write back once.
+//For a consistent view in the debugger use the mirror below (ctrl_snapshot).
+/////////////////////////////////////////CONTROLLER STATE///////////////////////////////////////////
+
+//PI loops of each converter, kept in one contiguous array per state (see ECI_PI.h).
+#define AFE_PLL 0		//vrq -> omega_pll
+#define AFE_VDC 1		//Vdc -> irdref
+#define AFE_IRD 2		//ird -> vrdref
+#define AFE_IRQ 3		//irq -> vrqref
+#define AFE_PI_LOOPS 4
+
+//abc vectors of the grid side converter, transformed together at the PLL angle.
+#define AFE_V 0			//input voltage va..vc -> vrd, vrq
+#define AFE_I 1			//input current ia..ic -> ird, irq
+#define AFE_ABC 2
+
+#define INV_VID 0		//vid -> u_vid
+#define INV_VIQ 1		//viq -> u_viq
+#define INV_PI_LOOPS 2
+
+#define OMEGA_PLL_MAX 1000.0f	//PLL output clamp [rad/s]
+#define IRDREF_MAX 30.0f		//Vdc loop output clamp, d axis current reference [A]
+#define VR_DQ_MAX 400.0f		//Rectifier current loop output clamp [V]
+#define VI_DQ_MAX 400.0f		//Inverter voltage loop output clamp [V]
+
+//int16 counts per unit of the packed trace
+#define TRACE_SCALE_V 64.0f		//+-512 V
+#define TRACE_SCALE_VDC 16.0f	//+-2048 V
+#define TRACE_SCALE_I 512.0f	//+-64 A
+
+//Analog monitor signals, the numbers used by SetMonitor() and the CAN route message
+#define MON_SIG_VA 0			//grid voltage, L-N
+#define MON_SIG_VB 1
+#define MON_SIG_VC 2
+#define MON_SIG_IA 3			//grid current
+#define MON_SIG_IB 4
+#define MON_SIG_IC 5
+#define MON_SIG_VDC 6
+#define MON_SIG_VD 7			//grid voltage dq
+#define MON_SIG_VQ 8
+#define MON_SIG_ID 9			//grid current dq
+#define MON_SIG_IQ 10
+#define MON_SIG_IRDREF 11		//Vdc loop output
+#define MON_SIG_OMEGA_PLL 12
+#define MON_SIG_VRA_REF 13		//rectifier phase a voltage reference
+#define MON_SIG_VIA 14			//INV output voltage
+#define MON_SIG_VIB 15
+#define MON_SIG_VIC 16
+#define MON_SIG_VID 17			//INV output voltage dq
+#define MON_SIG_VIQ 18
+#define MON_SIG_VZ_NPC 19		//NPC zero-sequence injection
+#define MON_SIG_DVNP 20			//NPC neutral point voltage difference
+#define MON_SIGNALS 21
+
+#define MON_GAIN_ADC(k) (MON_AO_MAX/(4096.0f*(k)))	//Full ADC span of a measurement scaled by k onto the DAC.
+#define MON_DIV 20				//Default route update, every 20 ISRs (1 kHz).
+
+//CAN receive mailboxes, the message IDs are in RackProfile[].  Enables: byte 0 is 1 to enable,
+//anything else disables.  Parameters: see ECI_Param.h.  Monitor routes, big endian: byte 0 AO
+//channel (bits 7-5) and signal (4-0), 1 div (0 = off), 2-3 offset [10 mV] int16, 4-7 gain
+//[V per unit] IEEE float32 like a PARAM_F32 value
+#define ENABLE_MBOX 1			//AFE or NPC enable
+#define INV_MBOX 2
+#define MON_MBOX 3
+#define PARAM_MBOX 4			//parameter requests, replies from PARAM_TX_MBOX with ID PARAM_CAN_ID + 1
+#define PARAM_TX_MBOX 5
+
+//Rack profiles, one image runs every rack.  The rack number comes from the OTP word RackIdOtp
+//when it is programmed, else from bits 9-10 of GetDI_Vec() (see SelectRack()).
+#define RACK_1B2B 0
+#define RACK_2B2B 1
+#define RACK_1NPC 2
+#define RACK_2NPC 3
+#define RACK_PROFILES 4
+#define RACK_ID_UNSET 0xFFFF	//erased OTP
+#define RACK_DI_SHIFT 9			//rack number = GetDI_10():GetDI_9(), inverted
+
+typedef struct
+{
+	Uint16 npc;						//1: NPC topology, 0: back to back AFE and INV
+	void (*control)(void);			//timer_isr() body, ControlB2B() or ControlNPC()
+	Uint32 enable_can_id;			//AFE or NPC enable
+	Uint32 inv_can_id;				//INV enable, B2B only
+	Uint32 mon_can_id;
+	Uint32 param_can_id;			//replies on param_can_id + 1
+} RACK_PROFILE;
+
+#ifndef OTP_CONST
+	#define OTP_CONST const				//ti_host.h drops it, host tests program the word
+#endif
+#pragma DATA_SECTION(RackIdOtp, "rackid")
+volatile OTP_CONST Uint16 RackIdOtp = RACK_ID_UNSET;	//programmed once per board, not by the image (DSECT),
+														//	volatile so the OTP word is read, not the initializer
+Uint16 RackId;
+const RACK_PROFILE *Rack;
+void (*RackControl)(void);				//Rack->control, the only indirect call in timer_isr()
+
+//Grid side converter (AFE), also the grid side of the NPC rack.
+typedef struct
+{
+	PI_CTRL pi[AFE_PI_LOOPS];		//PLL, Vdc, id and iq loops.
+	SINCOS3 sc_vin;					//sin/cos of phase_vin, kept from one ISR to the next for the PLL.
+	PHASE32 phase_vin;				//PLL angle, phase accumulator (2^32 = 2*pi)
+	float32 omega_pll;				//PLL frequency [rad/s]
+
+	float32 Vdcref;					//DC link voltage reference ***********set Vdc reference here**************
+	float32 irqref;					//input current, i, of rectifier, r, for q axis
+	float32 L;						//input inductor value for decoupling
+
+	float32 Vdc;					//measurements, filled in by timer_isr()
+	ABC3 abc[AFE_ABC];				//[AFE_V] input voltage va..vc, [AFE_I] input current ia..ic
+
+	DQ2 dq[AFE_ABC];				//abc[] in dq, [AFE_V] vrd/vrq, [AFE_I] ird/irq
+	float32 irdref;					//input current, i, of rectifier, r, for d axis (Vdc loop output)
+	DQ2 vrref;						//rectifier voltage dq references (vrdref, vrqref)
+	ABC3 vrabcref;					//rectifier voltage abc references [V] (vraref..vrcref)
+	ABC3 dr;						//rectifier pwm duty cycles
+	Uint16 dr_sat;					//SAT_x bits of the last modulation, freezes the id/iq integrators
+	Uint16 cmp[3];					//rectifier compare values
+} AFE_STATE;
+
+//Load side converter (INV) - JPL 9/10/2013
+typedef struct
+{
+	PI_CTRL pi[INV_PI_LOOPS];		//vd and vq loops.
+	SINCOS3 sc_vout;				//sin/cos of phase_vout.
+	PHASE32 phase_vout;				//output angle, phase accumulator (2^32 = 2*pi)
+	float32 w_inv;					//output frequency [rad/s]
+
+	float32 vidref;					//output voltage Vd reference, ramped up to vidref_max when enabled
+	float32 vidref_max;				//OUTPUT VOLTAGE Vd REF FOR INV HERE ******* (PARAM_VIDREF)
+	float32 viqref;
+
+	ABC3 vi;						//measurements via..vic, filled in by timer_isr()
+	ABC3 vi_rtds;					//INV voltage references from RTDS
+
+	DQ2 vidq;						//output voltage dq
+	DQ2 u;							//output voltage PI outputs (u_vid, u_viq)
+	ABC3 viref;						//output voltage abc references [V] (viaref..vicref)
+	ABC3 di;						//inverter pwm duty cycles
+	Uint16 di_sat;					//SAT_x bits of the last modulation, freezes the vd/vq integrators
+	Uint16 cmp[3];					//inverter compare values
+} INV_STATE;
+
+//Three-level NPC rack: grid side control plus the neutral point.
+typedef struct
+{
+	AFE_STATE afe;					//afe.dr holds the references normalized by Vdc.
+	float32 vab, vbc;				//measured line-line input voltages
+	float32 deltaVnp;				//neutral point voltage difference
+	Uint16 sector_code;				//comparison bits of the references, see NpcSector
+	Uint16 sector;					//sector 1..6
+	float32 vz_npc;					//zero-sequence injection
+	Uint16 cmp[6];					//compare values Na1, Na2, Nb1, Nb2, Nc1, Nc2
+} NPC_STATE;
+
+//All state of one controller.  timer_isr() runs Ctrl, the Init*() and Step*() functions take the
+//instance by pointer, so the host can run more instances side by side (host/eci_host.c).
+typedef struct
+{
+	AFE_STATE afe;					//B2B grid side
+	INV_STATE inv;					//B2B load side
+	NPC_STATE npc;
+} CTRL_STATE;
 
-/////////////////////////////////////////ISR///////////////////////////////////////////
-//Timer interrupt.  The frequency is linked to the PWM 1 interrupt
-/////////////////////////////////////////ISR///////////////////////////////////////////
+#pragma DATA_SECTION(Ctrl, "ctrlstate")
+CTRL_STATE Ctrl;
 
+//Debugger mirror.  Set ctrl_snapshot = 1 to copy the state once at the end of the next ISR,
+//or 2 to copy it every ISR.  Watch ctrl_dbg instead of the live state.
+volatile Uint16 ctrl_snapshot = 0;
+CTRL_STATE ctrl_dbg;
 
-interrupt void timer_isr(void)
+//ApplyParamsAFE(): Gains and setpoints of the parameter set p into s.
+void ApplyParamsAFE(AFE_STATE *s, const PARAM_VAL *p)
 {
+	SetGainsPI(&s->pi[AFE_PLL], p[PARAM_KP_PLL].f, p[PARAM_KI_PLL].f, T);
+	SetGainsPI(&s->pi[AFE_VDC], p[PARAM_KP_VDC].f, p[PARAM_KI_VDC].f, T);
+	SetGainsPI(&s->pi[AFE_IRD], p[PARAM_KP_IRD].f, p[PARAM_KI_IRD].f, T);
+	SetGainsPI(&s->pi[AFE_IRQ], p[PARAM_KP_IRQ].f, p[PARAM_KI_IRQ].f, T);
+	s->Vdcref = p[PARAM_VDCREF].f;
+	s->irqref = p[PARAM_IRQREF].f;
+	s->L = p[PARAM_L].f;
+}
 
-	// Clear INT flag for this timer
-	EPwm1Regs.ETCLR.bit.INT = 1;
-
-	SetDO_10(); //set output, square wave should be at 5k for 10kHz ISR (toggling is at 10k)
-
+//ApplyParamsCtrl(): Parameter set p into all state of c.
+void ApplyParamsCtrl(CTRL_STATE *c, const PARAM_VAL *p)
+{
+	ApplyParamsAFE(&c->afe, p);
+	ApplyParamsAFE(&c->npc.afe, p);
+	SetGainsPI(&c->inv.pi[INV_VID], p[PARAM_KP_VID].f, p[PARAM_KI_VID].f, T);
+	SetGainsPI(&c->inv.pi[INV_VIQ], p[PARAM_KP_VIQ].f, p[PARAM_KI_VIQ].f, T);
+	c->inv.vidref_max = p[PARAM_VIDREF].f;
+	c->inv.viqref = p[PARAM_VIQREF].f;
+	c->inv.w_inv = p[PARAM_W_INV].f;
+}
 
+//ApplyParams(): Parameter set p into Ctrl.  Runs from ParamBoundary() at the start of the ISR,
+//or from InitParams().
+void ApplyParams(const PARAM_VAL *p)
+{
+	ApplyParamsCtrl(&Ctrl, p);
+}
 
+//InitAFE(): Clamps and PLL angle of a grid side converter, gains and references come from ApplyParams().
+void InitAFE(AFE_STATE *s)
+{
+	InitPI(&s->pi[AFE_PLL], 0, 0, T, -OMEGA_PLL_MAX, OMEGA_PLL_MAX); //gains from ApplyParams()
+	InitPI(&s->pi[AFE_VDC], 0, 0, T, -IRDREF_MAX, IRDREF_MAX);
+	InitPI(&s->pi[AFE_IRD], 0, 0, T, -VR_DQ_MAX, VR_DQ_MAX);
+	InitPI(&s->pi[AFE_IRQ], 0, 0, T, -VR_DQ_MAX, VR_DQ_MAX);
+
+	s->phase_vin = 0;
+	s->omega_pll = 0;
+	UpdateSinCos3Phase(&s->sc_vin, s->phase_vin);
+}
 
+//InitINV(): Clamps and angle of the inverter, gains and references come from ApplyParams().
+void InitINV(INV_STATE *s)
+{
+	InitPI(&s->pi[INV_VID], 0, 0, T, -VI_DQ_MAX, VI_DQ_MAX); //gains from ApplyParams()
+	InitPI(&s->pi[INV_VIQ], 0, 0, T, -VI_DQ_MAX, VI_DQ_MAX);
 
-	float32 Vab, Vbc, Va, Vb, Vc, Vr1, Vr2, Ir1, Ir2, EVp, UVp, EVps, UVps, EVpc, UVpc, EVr, UVr, Ur1, Ur2, wd;
+	s->phase_vout = 0;
+	UpdateSinCos3Phase(&s->sc_vout, s->phase_vout);
 
-	float32 Vi1, Vi2, Ii1, Ii2, Vi2f, Vi1f, EVi1, EVi2, UVi1, UVi2, Ui1, Ui2, Ui3;
+	s->vidref = 170;
+}
 
-//	PieCtrlRegs.PIEACK.all = PIEACK_GROUP1;
-//	PieCtrlRegs.PIEACK.all = PIEACK_GROUP3;
-	StartADC();
+//InitCtrlState(): Clears c and sets the clamps and angles.  The gains and setpoints are 0 until
+//a parameter set is applied with ApplyParamsCtrl().
+void InitCtrlState(CTRL_STATE *c)
+{
+	memset(c, 0, sizeof(*c));
+	InitAFE(&c->afe);
+	InitINV(&c->inv);
+	InitAFE(&c->npc.afe);
+}
 
-#if defined(RK1B2B) || defined(RK2B2B)
-/////////////////////////////////////////REC///////////////////////////////////////////
+//InitTraceAFE(): Default trace, grid voltages, Vdc and currents of s rolling like the old
+//debug buffers.  Reconfigure TraceCfg from the debugger and set TraceArmReq for a triggered capture.
+void InitTraceAFE(const AFE_STATE *s)
+{
+	memset(&TraceCfg, 0, sizeof(TraceCfg));
+	SetTraceCh(0, &s->abc[AFE_V].a, TRACE_SCALE_V);
+	SetTraceCh(1, &s->abc[AFE_V].b, TRACE_SCALE_V);
+	SetTraceCh(2, &s->abc[AFE_V].c, TRACE_SCALE_V);
+	SetTraceCh(3, &s->Vdc, TRACE_SCALE_VDC);
+	SetTraceCh(4, &s->abc[AFE_I].a, TRACE_SCALE_I);
+	SetTraceCh(5, &s->abc[AFE_I].b, TRACE_SCALE_I);
+	SetTraceCh(6, &s->abc[AFE_I].c, TRACE_SCALE_I);
+	TraceCfg.nch = 7;
+	TraceCfg.decim = 1;
+	TraceCfg.trig = TRIG_NONE;
+	TraceCfg.trig_src = &s->Vdc;
+	TraceArm();
+}
 
+//InitMonitor(): Fills the monitor signal table with the signals of c, and sets the
+//default routes.  The old main loop wrote two groups of ADC channels to AO2-AO4 in turn, with AO1
+//at 0 or 3 V marking the group: A0/A1/A6 and A2/A3/A4 on B2B, A0/A1/A2 and B2/B3/B4 on NPC.  One
+//route per channel cannot alternate, so AO2-AO4 keep the group the controller measures, at the
+//same V per ADC count: B2B via/vib/vic (A0/A1/A6), NPC ia/ib/ic (B2/B3/B4).  The INV output currents
+//(A2-A4), Vdc1/Vdc2 and Idc+ (A0-A2 on NPC) are not controller signals.  AO1 is Vdc instead of the
+//group marker.
+void InitMonitor(CTRL_STATE *c)
+{
+	AFE_STATE *s = Rack->npc ? &c->npc.afe : &c->afe;
+
+	MonSignal[MON_SIG_VA] = &s->abc[AFE_V].a;
+	MonSignal[MON_SIG_VB] = &s->abc[AFE_V].b;
+	MonSignal[MON_SIG_VC] = &s->abc[AFE_V].c;
+	MonSignal[MON_SIG_IA] = &s->abc[AFE_I].a;
+	MonSignal[MON_SIG_IB] = &s->abc[AFE_I].b;
+	MonSignal[MON_SIG_IC] = &s->abc[AFE_I].c;
+	MonSignal[MON_SIG_VDC] = &s->Vdc;
+	MonSignal[MON_SIG_VD] = &s->dq[AFE_V].d;
+	MonSignal[MON_SIG_VQ] = &s->dq[AFE_V].q;
+	MonSignal[MON_SIG_ID] = &s->dq[AFE_I].d;
+	MonSignal[MON_SIG_IQ] = &s->dq[AFE_I].q;
+	MonSignal[MON_SIG_IRDREF] = &s->irdref;
+	MonSignal[MON_SIG_OMEGA_PLL] = &s->omega_pll;
+	MonSignal[MON_SIG_VRA_REF] = &s->vrabcref.a;
+	MonSignal[MON_SIG_VIA] = &c->inv.vi.a;
+	MonSignal[MON_SIG_VIB] = &c->inv.vi.b;
+	MonSignal[MON_SIG_VIC] = &c->inv.vi.c;
+	MonSignal[MON_SIG_VID] = &c->inv.vidq.d;
+	MonSignal[MON_SIG_VIQ] = &c->inv.vidq.q;
+	MonSignal[MON_SIG_VZ_NPC] = &c->npc.vz_npc;
+	MonSignal[MON_SIG_DVNP] = &c->npc.deltaVnp;
+	MonSignals = MON_SIGNALS;
+	ResetMonitor();
+
+	if(Rack->npc)
+	{
+		SetMonitor(0, MON_SIG_VDC, MON_GAIN_ADC(2*0.2687f), 0.0f, MON_DIV);	//A0 + A1
+		SetMonitor(1, MON_SIG_IA, MON_GAIN_ADC(0.01723f), 1.5f, MON_DIV);		//B2
+		SetMonitor(2, MON_SIG_IB, MON_GAIN_ADC(0.01723f), 1.5f, MON_DIV);		//B3
+		SetMonitor(3, MON_SIG_IC, MON_GAIN_ADC(0.01723f), 1.5f, MON_DIV);		//B4
+	}
+	else
+	{
+		SetMonitor(0, MON_SIG_VDC, MON_GAIN_ADC(0.2687f), 1.5f, MON_DIV);		//B5
+		SetMonitor(1, MON_SIG_VIA, MON_GAIN_ADC(0.1705f), 1.5f, MON_DIV);		//A0
+		SetMonitor(2, MON_SIG_VIB, MON_GAIN_ADC(0.1705f), 1.5f, MON_DIV);		//A1
+		SetMonitor(3, MON_SIG_VIC, MON_GAIN_ADC(0.1705f), 1.5f, MON_DIV);		//A6
+	}
+}
 
-	////////////////////////////////////////////////////////////////////////
-	//input current and DC link voltage measurements
-	////////////////////////////////////////////////////////////////////////
+//InitCtrl(): Clears and initializes all controller state for the rack picked by SelectRack().
+//Call before DSP_init() enables the ISR.
+void InitCtrl()
+{
+	InitCtrlState(&Ctrl);
+	AFEenable = 0;
+	INVenable = 0;
+	NPCenable = 0;
+	IsrEnable = 0;
+	InitParams(ParamDef, PARAMS, ApplyParams);
+	InitTraceAFE(Rack->npc ? &Ctrl.npc.afe : &Ctrl.afe);
+	InitMonitor(&Ctrl);
+	CaptureArm(RackId);						//first ticks from the cleared state, replayable on the host
+}
 
-	ia = 0.01723*(GetAIN_B2()-2048); //  0.01723 = 1/[1/1000*178.5*0.2382*2048/1.5]
-	ib = 0.01723*(GetAIN_B3()-2048); //  0.01723 = 1/[1/1000*178.5*0.2382*2048/1.5]
-	ic = 0.01723*(GetAIN_B4()-2048); //  0.01723 = 1/[1/1000*178.5*0.2382*2048/1.5]
+//SnapshotCtrl(): Copies the controller state to the debugger mirror when asked by ctrl_snapshot.
+inline void SnapshotCtrl()
+{
+	if(ctrl_snapshot != 0)
+	{
+		ctrl_dbg = Ctrl;
+		if(ctrl_snapshot == 1) ctrl_snapshot = 0;
+	}
+}
 
-	Vdc = 0.2687*(GetAIN_B5()-2048); // 0.2687 = 1/[1/39k*2.5*178.5*0.2382*2048/1.5]
+/////////////////////////////////////////REC///////////////////////////////////////////
+//StepAFE(): PLL, abc->dq, Vdc and id/iq PI loops and dq->abc for one ISR.  The measurements
+//(Vdc, abc[]) must be filled in first.  Leaves vrabcref in volts.
+//If the converter is not enabled from CANbus the loops are reset.
+//With DEGRADE_VDC in skip the Vdc loop is not run and the last irdref is held.
+/////////////////////////////////////////REC///////////////////////////////////////////
+void StepAFE(AFE_STATE *s, int enable, Uint16 skip)
+{
+	float32 L = s->L;
+	float32 omega_pll, irdref;
+	PHASE32 phase_vin;
+	DQ2 dq[AFE_ABC];
+	DQ2 vrref;
 
 	////////////////////////////////////////////////////////////////////////
-	//input voltage L-L --> L-N
+	//PLL angle, uses last omega
 	////////////////////////////////////////////////////////////////////////
-
-//	vab = 0.1705*(GetAIN_B0()-2048); //  0.1705 = 1/[1/24.75k*2.5*178.5*0.2382*2048/1.5]
-//	vbc = 0.1705*(GetAIN_B1()-2048); //  0.1705 = 1/[1/24.75k*2.5*178.5*0.2382*2048/1.5]
-
-//	va = 0.333333 * ( 2*vab+vbc);
-//	vb = 0.333333 * ( vbc-vab);
-//	vc = 0.333333 * ( -vab-2*vbc);
-
-	va = 0.1705*(GetAIN_B0()-2048);
-	vb = 0.1705*(GetAIN_B1()-2048);
-	vc = 0.1705*(GetAIN_B6()-2048);
+	phase_vin = s->phase_vin + PhaseStep(s->omega_pll, T); //integrator for omega to find theta, wraps at 2pi by overflow
+	UpdateSinCos3Phase(&s->sc_vin, phase_vin); //one sin/cos pair per ISR for all transforms at this angle
 
 	////////////////////////////////////////////////////////////////////////
-	//PLL (includes abc->dq for input voltages once the phase is locked on)
+	//abc->dq transform for input voltage and current in one pass
 	////////////////////////////////////////////////////////////////////////
-	vrd = 0.666667*(va*cos(theta_vin) + vb*cos(theta_vin-2.0944) + vc*cos(theta_vin+2.0944)) ;
-	vrq = 0.666667*(-va*sin(theta_vin) - vb*sin(theta_vin-2.0944) - vc*sin(theta_vin+2.0944)) ;
-
+	ClarkePark(&s->sc_vin, s->abc, dq, AFE_ABC);
 
 	//PLECS PLL
+	omega_pll = UpdatePI(&s->pi[AFE_PLL], dq[AFE_V].q); //PI control, drives vrq to zero
+	ProfMark(PROF_PLL);
 
-	omega_pll = omega_plln1+(ki_pll*T-kp_pll)*vrqn1+kp_pll*vrq; //PI control
-
-	theta_vin = theta_vinn1+omega_plln1*T; //self-resetting integrator for omega to find theta
-	if (theta_vin > 6.28319) {theta_vin = theta_vin-6.28319;} //reset integrator at 2pi
-	theta_vinn1 = theta_vin; //update delayed variable
-
-	vrqn1 = vrq; //update delayed variable
-	//if (omega_pll > 502.0) {omega_pll = 502.0;}
-	//if (omega_pll < -502.0) {omega_pll = -502.0;}
-	omega_plln1 = omega_pll; //update delayed variable
-
-	////////////////////////////////////////////////////////////////////////
-	//abc->dq transform for input current
-	////////////////////////////////////////////////////////////////////////
-	ird = 0.666667*(ia*cos(theta_vin) + ib*cos(theta_vin-2.0944) + ic*cos(theta_vin+2.0944)) ;
-	irq = 0.666667*(-ia*sin(theta_vin) - ib*sin(theta_vin-2.0944) - ic*sin(theta_vin+2.0944)) ;
 
-
-//if AFE is enabled from CANbus control, perform Vdc, ird, irq PI loops, else reset the loops
-if(AFEenable == 1)
+//if the converter is enabled from CANbus control, perform Vdc, ird, irq PI loops, else reset the loops
+if(enable == 1)
 {
 	////////////////////////////////////////////////////////////////////
 	// Vdc PI control
 	////////////////////////////////////////////////////////////////////
-	e_vdc = Vdcref-Vdc;
-
-	irdref = irdrefn1+(ki_vdc*T-kp_vdc)*e_vdcn1+kp_vdc*e_vdc; //id reference from Vdc PI control
-
-	irdrefn1 = irdref; //update delayed variable
-	e_vdcn1 = e_vdc; //update delayed variable
+	if(skip & DEGRADE_VDC)
+	{irdref = s->irdref;} //degraded tick, slow loop held
+	else
+	{irdref = UpdatePI(&s->pi[AFE_VDC], s->Vdcref-s->Vdc);} //id reference from Vdc PI control
 
 	////////////////////////////////////////////////////////////////////
-	// id, iq PI control, note iqref set to 0 in variable declarations
+	// id, iq PI control
 	////////////////////////////////////////////////////////////////////
 	//Vd* PI
-	e_ird = irdref-ird;  //error = id*-id
-	u_ird = u_irdn1+(ki_ird*T-kp_ird)*e_irdn1+kp_ird*e_ird; //PI control
-	vrdref = u_ird-irq*2*PI*60*L; //add decoupling term
-	vrdref = vrd-vrdref;
-
-	e_irdn1 = e_ird; //update delayed variable
-	u_irdn1 = u_ird; //update delayed variable
-
+	vrref.d = UpdatePIHold(&s->pi[AFE_IRD], irdref-dq[AFE_I].d, s->dr_sat)-dq[AFE_I].q*2*PI*60*L; //error = id*-id, add decoupling term
+	vrref.d = dq[AFE_V].d-vrref.d;
 
 	//Vq* PI
-	e_irq = irqref-irq; //error = iq*-iq
-	u_irq = u_irqn1+(ki_irq*T-kp_irq)*e_irqn1+kp_irq*e_irq; //PI control
-	vrqref = u_irq+ird*2*PI*60*L; //add decoupling term
-	vrqref = vrq-vrqref;
-
-	e_irqn1 = e_irq; //update delayed variable
-	u_irqn1 = u_irq; //update delayed variable
+	vrref.q = UpdatePIHold(&s->pi[AFE_IRQ], s->irqref-dq[AFE_I].q, s->dr_sat)+dq[AFE_I].d*2*PI*60*L; //error = iq*-iq, add decoupling term
+	vrref.q = dq[AFE_V].q-vrref.q;
 }
 else
 {
-	e_vdc = 0;
 	irdref = 0;
-	irdrefn1 = 0;
-	e_vdcn1 = 0;
-
-	e_ird = 0;
-	u_ird = 0;
-	vrdref = 0;
-	e_irdn1 = 0;
-	u_irdn1 = 0;
-
-	e_irq = 0;
-	u_irq = 0;
-	vrqref = 0;
-	e_irqn1 = 0;
-	u_irqn1 = 0;
+	vrref.d = 0;
+	vrref.q = 0;
+	ResetPI(&s->pi[AFE_VDC]);
+	ResetPI(&s->pi[AFE_IRD]);
+	ResetPI(&s->pi[AFE_IRQ]);
 }
 
 
 	////////////////////////////////////////////////////////////////////////
 	//dq->abc inverse transform for vd, vq references
 	////////////////////////////////////////////////////////////////////////
-	vraref = vrdref*cos(theta_vin) - vrqref*sin(theta_vin);
-	vrbref = vrdref*cos(theta_vin-2.0944) - vrqref*sin(theta_vin-2.0944);
-	vrcref = vrdref*cos(theta_vin+2.0944) - vrqref*sin(theta_vin+2.0944);
-
-	// TEST CODE FOR BENCHTOP TESTING OF UPDOWN PWM
-//	Vdc = 200;
-//	vraref = 75*cos(theta_vout);
-//	vrbref = 75*cos(theta_vout-2.0944);
-//	vrcref = 75*cos(theta_vout+2.0944);
-
-
-	//PWM
-	dra = 0.5*(vraref/(Vdc/2))+0.5; //scale by Vdc then shrink+shift for [-1 1] modulation to [0 1]
-	drb = 0.5*(vrbref/(Vdc/2))+0.5; //scale by Vdc then shrink+shift for [-1 1] modulation to [0 1]
-	drc = 0.5*(vrcref/(Vdc/2))+0.5; //scale by Vdc then shrink+shift for [-1 1] modulation to [0 1]
-
-	//set PWM duty out
-	SetPWM_Rau(dra*PWM_PD);  //dra is [0 1], i.e. percentage of PWM_PD, the clock cycles of PWM period
-	SetPWM_Rbu(drb*PWM_PD);  //dra is [0 1], i.e. percentage of PWM_PD, the clock cycles of PWM period
-	SetPWM_Rcu(drc*PWM_PD);  //dra is [0 1], i.e. percentage of PWM_PD, the clock cycles of PWM period
-
-/////////////////////////////////////////END OF REC CODE///////////////////////////////////////////
+	ClarkeParkInv(&s->sc_vin, &vrref, &s->vrabcref, 1);
+	ProfMark(PROF_LOOPS);
 
+	//write back
+	s->phase_vin = phase_vin;
+	s->omega_pll = omega_pll;
+	s->dq[AFE_V] = dq[AFE_V];
+	s->dq[AFE_I] = dq[AFE_I];
+	s->irdref = irdref;
+	s->vrref = vrref;
+}
 
 ///////////////////////////////////////////////////////////////////////////////////////
-//                                  INV
+//StepINV(): Output angle, abc->dq, vd/vq PI loops and dq->abc for one ISR.  The output
+//voltages (vi) must be filled in first.  Leaves viref in volts.
+// Inverter controller changed to PI for vd and vq of INV output - Jesse 9/10/13
+//With DEGRADE_INV in skip only the angle advances, the last u is rotated to abc.
 ///////////////////////////////////////////////////////////////////////////////////////
+void StepINV(INV_STATE *s, int enable, Uint16 skip)
+{
+	float32 vidref;
+	PHASE32 phase_vout;
+	DQ2 vidq, u;
 
-	// 9/10/13
-	// Inverter controller changed to PI for vd and vq of INV output - Jesse 9/10/13
-
-	////////////////////////////////////////////////////////////////////////
-	//RTDS voltage references
-	////////////////////////////////////////////////////////////////////////
-	viaref_rtds = 0.1354*(GetAIN_B7()-2048);  //scale factor depends on scaling for GTAO too
-	vibref_rtds = 0.1354*(GetAIN_A5()-2048);  //scale factor depends on scaling for GTAO too
-	vicref_rtds = 0.1354*(GetAIN_A7()-2048);  //scale factor depends on scaling for GTAO too
-
-
-	theta_vout = theta_vout + w_inv*T;
-	//t_inv = t_inv + T;
-	if (theta_vout > 6.28319)
-		{theta_vout = theta_vout - 6.28319;
-	//	 t_inv = 0;
-		 }
-
-	////////////////////////////////////////////////////////////////////////
-	//output voltage measurement across LC filter capacitors
-	////////////////////////////////////////////////////////////////////////
-	via = 0.1705*(GetAIN_A0()-2048); // 0.1705 = 1/[1/24.75k*2.5*178.5*0.2382*2048/1.5]
-	vib = 0.1705*(GetAIN_A1()-2048); // 0.1705 = 1/[1/24.75k*2.5*178.5*0.2382*2048/1.5]
-	vic = 0.1705*(GetAIN_A6()-2048); // 0.1705 = 1/[1/24.75k*2.5*178.5*0.2382*2048/1.5]
+	phase_vout = s->phase_vout + PhaseStep(s->w_inv, T); //wraps at 2pi by overflow
+	UpdateSinCos3Phase(&s->sc_vout, phase_vout); //one sin/cos pair per ISR for the INV transforms
 
 	////////////////////////////////////////////////////////////////////////
 	//measured voltage abc-->dq
 	////////////////////////////////////////////////////////////////////////
-	vid = 0.666667*(via*cos(theta_vout) + vib*cos(theta_vout-2.0944) + vic*cos(theta_vout+2.0944)) ;
-	viq = 0.666667*(-via*sin(theta_vout) - vib*sin(theta_vout-2.0944) - vic*sin(theta_vout+2.0944)) ;
+	if(skip & DEGRADE_INV)
+	{vidq = s->vidq;} //degraded tick, measurement not used
+	else
+	{ClarkePark(&s->sc_vout, &s->vi, &vidq, 1);}
 
 
 //if INV is enabled from CANbus control, perform Vd, Vq PI loops, else reset the loops
-if(INVenable == 1)
+if(enable == 1 && (skip & DEGRADE_INV))
+{
+	//degraded tick, hold the ramp and loop outputs
+	vidref = s->vidref;
+	u = s->u;
+}
+else if(enable == 1)
 {
 	////////////////////////////////////////////////////////////////////////
 	//ramp INV output voltage
 	////////////////////////////////////////////////////////////////////////
-	if(vidref<170)
-	{vidref = vidref + 0.00283;}
+	vidref = s->vidref;
+	if(vidref<s->vidref_max)
+	{vidref = vidref + 0.00283f;}
 	else
-	{vidref = 170;}
+	{vidref = s->vidref_max;}
 
 	////////////////////////////////////////////////////////////////////////
 	//output voltage dq PI loops
 	////////////////////////////////////////////////////////////////////////
-	//Vd* PI
-	e_vid = vidref-vid;  //error = id*-id
-	u_vid = u_vidn1+(ki_vid*T-kp_vid)*e_vidn1+kp_vid*e_vid; //PI control
-
-	e_vidn1 = e_vid; //update delayed variable
-	u_vidn1 = u_vid; //update delayed variable
-
-
-	//Vq* PI
-	e_viq = viqref-viq; //error = iq*-iq
-	u_viq = u_viqn1+(ki_viq*T-kp_viq)*e_viqn1+kp_viq*e_viq; //PI control
-
-	e_viqn1 = e_viq; //update delayed variable
-	u_viqn1 = u_viq; //update delayed variable
+	u.d = UpdatePIHold(&s->pi[INV_VID], vidref-vidq.d, s->di_sat); //Vd* PI, error = vd*-vd
+	u.q = UpdatePIHold(&s->pi[INV_VIQ], s->viqref-vidq.q, s->di_sat); //Vq* PI, error = vq*-vq
 }
 else
 {
 	//for ramp
 	vidref = 10;
 
-	e_vid = 0;
-	u_vid = 0;
-	e_vidn1 = 0;
-	u_vidn1 = 0;
-
-	e_viq = 0;
-	u_viq = 0;
-	e_viqn1 = 0;
-	u_viqn1 = 0;
+	u.d = 0;
+	u.q = 0;
+	ResetPI(&s->pi[INV_VID]);
+	ResetPI(&s->pi[INV_VIQ]);
 }
 
 	////////////////////////////////////////////////////////////////////////
 	//dq->abc inverse transform for vd, vq references
 	////////////////////////////////////////////////////////////////////////
 	/* closed loop references */
-	viaref = u_vid*cos(theta_vout) - u_viq*sin(theta_vout);
-	vibref = u_vid*cos(theta_vout-2.0944) - u_viq*sin(theta_vout-2.0944);
-	vicref = u_vid*cos(theta_vout+2.0944) - u_viq*sin(theta_vout+2.0944);
-
-	/* open loop references */
-//	viaref = 170*cos(theta_vout);// - viqref*sin(theta_vout);
-//	vibref = 170*cos(theta_vout-2.0944);// - viqref*sin(theta_vout-2.0944);
-//	vicref = 170*cos(theta_vout+2.0944);// - viqref*sin(theta_vout+2.0944);
+	ClarkeParkInv(&s->sc_vout, &u, &s->viref, 1);
 
 	/* rtds open loop references */
-//	viaref = viaref_rtds;
-//	vibref = vibref_rtds;
-//	vicref = vicref_rtds;
+//	s->viref = s->vi_rtds;
 
-	//PWM
-	dia = 0.5*(viaref/(Vdc/2))+0.5; //scale by Vdc then shrink+shift for [-1 1] modulation to [0 1]
-	dib = 0.5*(vibref/(Vdc/2))+0.5; //scale by Vdc then shrink+shift for [-1 1] modulation to [0 1]
-	dic = 0.5*(vicref/(Vdc/2))+0.5; //scale by Vdc then shrink+shift for [-1 1] modulation to [0 1]
+	//write back
+	s->phase_vout = phase_vout;
+	s->vidq = vidq;
+	s->vidref = vidref;
+	s->u = u;
+}
 
+/////////////////////////////////////////NPC///////////////////////////////////////////
+//StepNPC(): Grid side control (StepAFE) plus sector and zero-sequence calculation for
+//the three-level NPC.  Leaves the references normalized by Vdc in afe.dr.  skip is passed
+//to StepAFE().
+/////////////////////////////////////////NPC///////////////////////////////////////////
+void StepNPC(NPC_STATE *s, int enable, Uint16 skip)
+{
+	float32 vraref, vrbref, vrcref, inv_vdc, vz_npc;
+	float32 vr[4], i[4];
+	Uint16 code = s->sector_code;
 
-	//set PWM duty out
-	SetPWM_Iau(dia*PWM_PD);  //dia is [0 1], i.e. percentage of PWM_PD, the clock cycles of PWM period
-	SetPWM_Ibu(dib*PWM_PD);  //dia is [0 1], i.e. percentage of PWM_PD, the clock cycles of PWM period
-	SetPWM_Icu(dic*PWM_PD);  //dia is [0 1], i.e. percentage of PWM_PD, the clock cycles of PWM period
+	StepAFE(&s->afe, enable, skip);
 
-/////////////////////////////////////////END OF INV CODE///////////////////////////////////////////
-#endif
+	inv_vdc = RecipVdc(s->afe.Vdc); //one guarded division per ISR
+	vraref = s->afe.vrabcref.a*inv_vdc;
+	vrbref = s->afe.vrabcref.b*inv_vdc;
+	vrcref = s->afe.vrabcref.c*inv_vdc;
 
-#if defined(RK1NPC) || defined(RK2NPC)
-/////////////////////////////////////////NPC///////////////////////////////////////////
+	////////////////////////////////////////////////////////////////////////
+	//zero-sequence calculation and injection, constant time (see ECI_Npc.h)
+	////////////////////////////////////////////////////////////////////////
+	vr[NPC_PH_A] = vraref;
+	vr[NPC_PH_B] = vrbref;
+	vr[NPC_PH_C] = vrcref;
+	vr[NPC_PH_0] = 0;
+	i[NPC_PH_A] = s->afe.abc[AFE_I].a;
+	i[NPC_PH_B] = s->afe.abc[AFE_I].b;
+	i[NPC_PH_C] = s->afe.abc[AFE_I].c;
+	i[NPC_PH_0] = 0;
+
+	vz_npc = NpcZeroSeq(vr, i, s->deltaVnp, &code); //holds the last sector on a tie
 
+//	vraref = vraref + vz_npc;
+//	vrbref = vrbref + vz_npc;
+//	vrcref = vrcref + vz_npc;
+
+	//PWM
+//	dra = 0.5*(vraref)+0.5; //scale by Vdc then shrink+shift for [-1 1] modulation to [0 1]
+//	drb = 0.5*(vrbref)+0.5; //scale by Vdc then shrink+shift for [-1 1] modulation to [0 1]
+//	drc = 0.5*(vrcref)+0.5; //scale by Vdc then shrink+shift for [-1 1] modulation to [0 1]
+
+	//write back
+	s->afe.dr.a = vraref;
+	s->afe.dr.b = vrbref;
+	s->afe.dr.c = vrcref;
+	s->sector_code = code;
+	s->sector = NpcSector[code].sector;
+	s->vz_npc = vz_npc;
+}
+
+/////////////////////////////////////////B2B///////////////////////////////////////////
+//StepCtrlB2B(): Measurements from ain[] (right aligned ADC results, indexed by AIN_A()/AIN_B()),
+//control and modulation of the back to back racks for one ISR.  enable holds the EN_x bits.
+//Leaves the compare values in c->afe.cmp and c->inv.cmp.
+/////////////////////////////////////////B2B///////////////////////////////////////////
+void StepCtrlB2B(CTRL_STATE *c, const float32 *ain, Uint16 enable, Uint16 skip)
+{
+	AFE_STATE *afe = &c->afe;
+	INV_STATE *inv = &c->inv;
+	float32 Vdc, inv_vdc;
+
+/////////////////////////////////////////REC///////////////////////////////////////////
 
 	////////////////////////////////////////////////////////////////////////
 	//input current and DC link voltage measurements
 	////////////////////////////////////////////////////////////////////////
 
-	ia = 0.01723*(GetAIN_B2()-2048); //  0.01723 = 1/[1/1000*178.5*0.2382*2048/1.5]
-	ib = 0.01723*(GetAIN_B3()-2048); //  0.01723 = 1/[1/1000*178.5*0.2382*2048/1.5]
-	ic = 0.01723*(GetAIN_B4()-2048); //  0.01723 = 1/[1/1000*178.5*0.2382*2048/1.5]
+	afe->abc[AFE_I].a = 0.01723f*(ain[AIN_B(2)]-2048); //  0.01723 = 1/[1/1000*178.5*0.2382*2048/1.5]
+	afe->abc[AFE_I].b = 0.01723f*(ain[AIN_B(3)]-2048); //  0.01723 = 1/[1/1000*178.5*0.2382*2048/1.5]
+	afe->abc[AFE_I].c = 0.01723f*(ain[AIN_B(4)]-2048); //  0.01723 = 1/[1/1000*178.5*0.2382*2048/1.5]
 
-	Vdc = 0.2687*(GetAIN_A0() + GetAIN_A1() - 4096); // 0.2687 = 1/[1/39k*2.5*178.5*0.2382*2048/1.5]
-	deltaVnp = 0.2687*(GetAIN_A0() - GetAIN_A1());   // 0.2687 = 1/[1/39k*2.5*178.5*0.2382*2048/1.5]
+	Vdc = 0.2687f*(ain[AIN_B(5)]-2048); // 0.2687 = 1/[1/39k*2.5*178.5*0.2382*2048/1.5]
+	afe->Vdc = Vdc;
+	inv_vdc = RecipVdc(Vdc); //one guarded division per ISR, shared by REC and INV
 
 	////////////////////////////////////////////////////////////////////////
-	//input voltage L-L --> L-N
+	//input voltage L-N
 	////////////////////////////////////////////////////////////////////////
 
-	vab = 0.1705*(GetAIN_B0()-2048); //  0.1705 = 1/[1/24.75k*2.5*178.5*0.2382*2048/1.5]
-	vbc = 0.1705*(GetAIN_B1()-2048); //  0.1705 = 1/[1/24.75k*2.5*178.5*0.2382*2048/1.5]
+	afe->abc[AFE_V].a = 0.1705f*(ain[AIN_B(0)]-2048); //  0.1705 = 1/[1/24.75k*2.5*178.5*0.2382*2048/1.5]
+	afe->abc[AFE_V].b = 0.1705f*(ain[AIN_B(1)]-2048);
+	afe->abc[AFE_V].c = 0.1705f*(ain[AIN_B(6)]-2048);
+	ProfMark(PROF_ADC);
 
-	va = 0.333333 * ( 2*vab+vbc);
-	vb = 0.333333 * ( vbc-vab);
-	vc = 0.333333 * ( -vab-2*vbc);
+	StepAFE(afe, (enable & EN_AFE) != 0, skip);
 
-//	va = 0.1705*(GetAIN_B0()-2048);
-//	vb = 0.1705*(GetAIN_B1()-2048);
-//	vc = 0.1705*(GetAIN_B6()-2048);
+	//PWM is modulated together with the INV below
+
+/////////////////////////////////////////END OF REC CODE///////////////////////////////////////////
+
+
+///////////////////////////////////////////////////////////////////////////////////////
+//                                  INV
+///////////////////////////////////////////////////////////////////////////////////////
 
 	////////////////////////////////////////////////////////////////////////
-	//PLL (includes abc->dq for input voltages once the phase is locked on)
+	//RTDS voltage references
 	////////////////////////////////////////////////////////////////////////
-	vrd = 0.666667*(va*cos(theta_vin) + vb*cos(theta_vin-2.0944) + vc*cos(theta_vin+2.0944)) ;
-	vrq = 0.666667*(-va*sin(theta_vin) - vb*sin(theta_vin-2.0944) - vc*sin(theta_vin+2.0944)) ;
+	inv->vi_rtds.a = 0.1354f*(ain[AIN_B(7)]-2048);  //scale factor depends on scaling for GTAO too
+	inv->vi_rtds.b = 0.1354f*(ain[AIN_A(5)]-2048);  //scale factor depends on scaling for GTAO too
+	inv->vi_rtds.c = 0.1354f*(ain[AIN_A(7)]-2048);  //scale factor depends on scaling for GTAO too
 
+	////////////////////////////////////////////////////////////////////////
+	//output voltage measurement across LC filter capacitors
+	////////////////////////////////////////////////////////////////////////
+	inv->vi.a = 0.1705f*(ain[AIN_A(0)]-2048); // 0.1705 = 1/[1/24.75k*2.5*178.5*0.2382*2048/1.5]
+	inv->vi.b = 0.1705f*(ain[AIN_A(1)]-2048); // 0.1705 = 1/[1/24.75k*2.5*178.5*0.2382*2048/1.5]
+	inv->vi.c = 0.1705f*(ain[AIN_A(6)]-2048); // 0.1705 = 1/[1/24.75k*2.5*178.5*0.2382*2048/1.5]
 
-	//PLECS PLL
+	StepINV(inv, (enable & EN_INV) != 0, skip);
+	ProfMark(PROF_INV);
 
-	omega_pll = omega_plln1+(ki_pll*T-kp_pll)*vrqn1+kp_pll*vrq; //PI control
+	//PWM, scale by Vdc then shift for [-1 1] modulation to [0 1], clamped
+	afe->dr_sat = Modulate2L(&afe->vrabcref, inv_vdc, &afe->dr, afe->cmp);
+	inv->di_sat = Modulate2L(&inv->viref, inv_vdc, &inv->di, inv->cmp);
 
-	theta_vin = theta_vinn1+omega_plln1*T; //self-resetting integrator for omega to find theta
-	if (theta_vin > 6.28319) {theta_vin = theta_vin-6.28319;} //reset integrator at 2pi
-	theta_vinn1 = theta_vin; //update delayed variable
+/////////////////////////////////////////END OF INV CODE///////////////////////////////////////////
+}
 
-	vrqn1 = vrq; //update delayed variable
-	//if (omega_pll > 502.0) {omega_pll = 502.0;}
-	//if (omega_pll < -502.0) {omega_pll = -502.0;}
-	omega_plln1 = omega_pll; //update delayed variable
+/////////////////////////////////////////NPC///////////////////////////////////////////
+//StepCtrlNPC(): Measurements from ain[] (as StepCtrlB2B()), control and modulation of the NPC
+//racks for one ISR.  Leaves the compare values in c->npc.cmp.
+/////////////////////////////////////////NPC///////////////////////////////////////////
+void StepCtrlNPC(CTRL_STATE *c, const float32 *ain, Uint16 enable, Uint16 skip)
+{
+	NPC_STATE *npc = &c->npc;
 
 	////////////////////////////////////////////////////////////////////////
-	//abc->dq transform for input current
+	//input current and DC link voltage measurements
 	////////////////////////////////////////////////////////////////////////
-	ird = 0.666667*(ia*cos(theta_vin) + ib*cos(theta_vin-2.0944) + ic*cos(theta_vin+2.0944)) ;
-	irq = 0.666667*(-ia*sin(theta_vin) - ib*sin(theta_vin-2.0944) - ic*sin(theta_vin+2.0944)) ;
 
+	npc->afe.abc[AFE_I].a = 0.01723f*(ain[AIN_B(2)]-2048); //  0.01723 = 1/[1/1000*178.5*0.2382*2048/1.5]
+	npc->afe.abc[AFE_I].b = 0.01723f*(ain[AIN_B(3)]-2048); //  0.01723 = 1/[1/1000*178.5*0.2382*2048/1.5]
+	npc->afe.abc[AFE_I].c = 0.01723f*(ain[AIN_B(4)]-2048); //  0.01723 = 1/[1/1000*178.5*0.2382*2048/1.5]
 
-//if NPC is enabled from CANbus control, perform Vdc, ird, irq PI loops, else reset the loops
-if(NPCenable == 1)
-{
-	////////////////////////////////////////////////////////////////////
-	// Vdc PI control
-	////////////////////////////////////////////////////////////////////
-	e_vdc = Vdcref-Vdc;
-
-	irdref = irdrefn1+(ki_vdc*T-kp_vdc)*e_vdcn1+kp_vdc*e_vdc; //id reference from Vdc PI control
+	npc->afe.Vdc = 0.2687f*(ain[AIN_A(0)] + ain[AIN_A(1)] - 4096); // 0.2687 = 1/[1/39k*2.5*178.5*0.2382*2048/1.5]
+	npc->deltaVnp = 0.2687f*(ain[AIN_A(0)] - ain[AIN_A(1)]);   // 0.2687 = 1/[1/39k*2.5*178.5*0.2382*2048/1.5]
 
-	irdrefn1 = irdref; //update delayed variable
-	e_vdcn1 = e_vdc; //update delayed variable
+	////////////////////////////////////////////////////////////////////////
+	//input voltage L-L --> L-N
+	////////////////////////////////////////////////////////////////////////
+	{
+	float32 vab = 0.1705f*(ain[AIN_B(0)]-2048); //  0.1705 = 1/[1/24.75k*2.5*178.5*0.2382*2048/1.5]
+	float32 vbc = 0.1705f*(ain[AIN_B(1)]-2048); //  0.1705 = 1/[1/24.75k*2.5*178.5*0.2382*2048/1.5]
+
+	npc->vab = vab;
+	npc->vbc = vbc;
+	npc->afe.abc[AFE_V].a = 0.333333f * ( 2*vab+vbc);
+	npc->afe.abc[AFE_V].b = 0.333333f * ( vbc-vab);
+	npc->afe.abc[AFE_V].c = 0.333333f * ( -vab-2*vbc);
+	}
+	ProfMark(PROF_ADC);
 
-	////////////////////////////////////////////////////////////////////
-	// id, iq PI control, note iqref set to 0 in variable declarations
-	////////////////////////////////////////////////////////////////////
-	//Vd* PI
-	e_ird = irdref-ird;  //error = id*-id
-	u_ird = u_irdn1+(ki_ird*T-kp_ird)*e_irdn1+kp_ird*e_ird; //PI control
-	vrdref = u_ird-irq*2*PI*60*L; //add decoupling term
-	vrdref = vrd-vrdref;
+	StepNPC(npc, (enable & EN_NPC) != 0, skip);
 
-	e_irdn1 = e_ird; //update delayed variable
-	u_irdn1 = u_ird; //update delayed variable
+	//dra, drb, drc are [-1,1], vertical shift by -1 to enable PWM clamping
+	npc->afe.dr_sat = ModulateNPC(&npc->afe.dr, npc->cmp);
 
+/////////////////////////////////////////END OF NPC CODE///////////////////////////////////////////
+}
 
-	//Vq* PI
-	e_irq = irqref-irq; //error = iq*-iq
-	u_irq = u_irqn1+(ki_irq*T-kp_irq)*e_irqn1+kp_irq*e_irq; //PI control
-	vrqref = u_irq+ird*2*PI*60*L; //add decoupling term
-	vrqref = vrq-vrqref;
+/////////////////////////////////////////RACK///////////////////////////////////////////
+//ControlB2B(), ControlNPC(): timer_isr() bodies, the step of Ctrl on this period's ADC results
+//and the compare writes.
+/////////////////////////////////////////RACK///////////////////////////////////////////
+void ControlB2B(void)
+{
+	StepCtrlB2B(&Ctrl, AdcAin, IsrEnable, IsrSkip);
 
-	e_irqn1 = e_irq; //update delayed variable
-	u_irqn1 = u_irq; //update delayed variable
+	//set PWM duty out, all six compare values back to back
+	SetPWM_R(Ctrl.afe.cmp);
+	SetPWM_I(Ctrl.inv.cmp);
+	LoadCmpWritten(); //against the shadow load, CMP_DEADLINE after the trigger
+	ProfMark(PROF_MOD);
 }
-else
+
+void ControlNPC(void)
 {
-	e_vdc = 0;
-	irdref = 0;
-	irdrefn1 = 0;
-	e_vdcn1 = 0;
-
-	e_ird = 0;
-	u_ird = 0;
-	vrdref = 0;
-	e_irdn1 = 0;
-	u_irdn1 = 0;
-
-	e_irq = 0;
-	u_irq = 0;
-	vrqref = 0;
-	e_irqn1 = 0;
-	u_irqn1 = 0;
+	StepCtrlNPC(&Ctrl, AdcAin, IsrEnable, IsrSkip);
+
+	SetPWM_N(Ctrl.npc.cmp);
+	LoadCmpWritten(); //against the shadow load, CMP_DEADLINE after the trigger
+	ProfMark(PROF_MOD);	//includes the sector and zero-sequence selection in StepNPC()
 }
 
+/////////////////////////////////////////ISR///////////////////////////////////////////
+//Timer interrupt.  The frequency is linked to the PWM 1 interrupt, or to the end of the
+//ADC sequence started by PWM 1 SOCA when ADC_SOCA_TRIGGER is set, or to the end of the
+//DMA transfer of one period's ADC sequences when ADC_DMA is set.
+/////////////////////////////////////////ISR///////////////////////////////////////////
 
-	////////////////////////////////////////////////////////////////////////
-	//dq->abc inverse transform for vd, vq references
-	////////////////////////////////////////////////////////////////////////
-	vraref = (vrdref*cos(theta_vin) - vrqref*sin(theta_vin))/Vdc;
-	vrbref = (vrdref*cos(theta_vin-2.0944) - vrqref*sin(theta_vin-2.0944))/Vdc;
-	vrcref = (vrdref*cos(theta_vin+2.0944) - vrqref*sin(theta_vin+2.0944))/Vdc;
 
-	////////////////////////////////////////////////////////////////////////
-	//zero-sequence calculation and injection
-	////////////////////////////////////////////////////////////////////////
-	if (vraref > vrbref && vraref > vrcref && vrcref < vrbref) {sector = 1;}
-	else if (vrbref > vraref && vrbref > vrcref && vrcref < vraref) {sector = 2;}
-	else if (vrbref > vraref && vrbref > vrcref && vraref < vrcref) {sector = 3;}
-	else if (vrcref > vraref && vrcref > vrbref && vraref < vrbref) {sector = 4;}
-	else if (vrcref > vraref && vrcref > vrbref && vrbref < vraref) {sector = 5;}
-	else if (vraref > vrbref && vraref > vrcref && vrbref < vrcref) {sector = 6;}
-
-	if (sector == 1){
-		if (!(deltaVnp*ia > 0) && !(deltaVnp*ic > 0)){vz_npc = -vrbref;}
-		if (!(deltaVnp*ia > 0) &&  (deltaVnp*ic > 0)){vz_npc = 1-vraref;}
-		if ( (deltaVnp*ia > 0) && !(deltaVnp*ic > 0)){vz_npc = -1-vrcref;}
-		if ( (deltaVnp*ia > 0) &&  (deltaVnp*ic > 0)){
-			if (vrbref > 0){vz_npc = 1-vraref;}
-			else {vz_npc = -1-vrcref;}}
-	}
-	else if (sector == 2){
-		if (!(deltaVnp*ib > 0) && !(deltaVnp*ic > 0)){vz_npc = -vraref;}
-		if (!(deltaVnp*ib > 0) &&  (deltaVnp*ic > 0)){vz_npc = 1-vrbref;}
-		if ( (deltaVnp*ib > 0) && !(deltaVnp*ic > 0)){vz_npc = -1-vrcref;}
-		if ( (deltaVnp*ib > 0) &&  (deltaVnp*ic > 0)){
-			if (vraref > 0){vz_npc = 1-vrbref;}
-			else {vz_npc = -1-vrcref;}}
-	}
-	else if (sector == 3){
-		if (!(deltaVnp*ib > 0) && !(deltaVnp*ia > 0)){vz_npc = -vrcref;}
-		if (!(deltaVnp*ib > 0) &&  (deltaVnp*ia > 0)){vz_npc = 1-vrbref;}
-		if ( (deltaVnp*ib > 0) && !(deltaVnp*ia > 0)){vz_npc = -1-vraref;}
-		if ( (deltaVnp*ib > 0) &&  (deltaVnp*ia > 0)){
-			if (vrcref > 0){vz_npc = 1-vrbref;}
-			else {vz_npc = -1-vraref;}}
-	}
-	else if (sector == 4){
-		if (!(deltaVnp*ia > 0) && !(deltaVnp*ic > 0)){vz_npc = -vrbref;}
-		if (!(deltaVnp*ia > 0) &&  (deltaVnp*ic > 0)){vz_npc = -1-vraref;}
-		if ( (deltaVnp*ia > 0) && !(deltaVnp*ic > 0)){vz_npc = 1-vrcref;}
-		if ( (deltaVnp*ia > 0) &&  (deltaVnp*ic > 0)){
-			if (vrbref > 0){vz_npc = 1-vrcref;}
-			else {vz_npc = -1-vraref;}}
-	}
-	else if (sector == 5){
-		if (!(deltaVnp*ib > 0) && !(deltaVnp*ic > 0)){vz_npc = -vraref;}
-		if (!(deltaVnp*ib > 0) &&  (deltaVnp*ic > 0)){vz_npc = -1-vrbref;}
-		if ( (deltaVnp*ib > 0) && !(deltaVnp*ic > 0)){vz_npc = 1-vrcref;}
-		if ( (deltaVnp*ib > 0) &&  (deltaVnp*ic > 0)){
-			if (vraref > 0){vz_npc = 1-vrcref;}
-			else {vz_npc = -1-vrbref;}}
-	}
-	else if (sector == 6){
-		if (!(deltaVnp*ib > 0) && !(deltaVnp*ia > 0)){vz_npc = -vrcref;}
-		if (!(deltaVnp*ib > 0) &&  (deltaVnp*ia > 0)){vz_npc = -1-vrbref;}
-		if ( (deltaVnp*ib > 0) && !(deltaVnp*ia > 0)){vz_npc = 1-vraref;}
-		if ( (deltaVnp*ib > 0) &&  (deltaVnp*ia > 0)){
-			if (vrcref > 0){vz_npc = 1-vraref;}
-			else {vz_npc = -1-vrbref;}}
-	}
-
-//	vraref = vraref + vz_npc;
-//	vrbref = vrbref + vz_npc;
-//	vrcref = vrcref + vz_npc;
+interrupt void timer_isr(void)
+{
+	LoadStart(); //carrier position at entry, picks up the skips from an overrun or high load last tick
+	ProfStart();
 
+	// Clear INT flag for this interrupt (EPwm1 or ADC SEQ1, see ADC_SOCA_TRIGGER)
+	ClearControlISR();
+	ParamBoundary(); //committed gains and setpoints go live here, before anything can preempt the ISR
+	IsrEnable = (Uint16)(AFEenable == 1) | ((Uint16)(INVenable == 1) << 1) | ((Uint16)(NPCenable == 1) << 2);
+	AllowCanRx(); //a CAN disable command may preempt the rest of the ISR
 
-	// TEST CODE FOR BENCHTOP TESTING OF UPDOWN PWM
-//	theta_vout = theta_vout + w_inv*T;
-//	if (theta_vout > 6.28319)
-//		{theta_vout = theta_vout - 6.28319;}
-//	Vdc = 200;
-//	vraref = 1*cos(theta_vout);
-//	vrbref = 1*cos(theta_vout-2.0944);
-//	vrcref = 1*cos(theta_vout+2.0944);
+	SetDO_10(); //set output, square wave should be at 5k for 10kHz ISR (toggling is at 10k)
 
+	StartADC();
+	ReadAIN(); //AdcAin[], the measurements of this tick
 
-	//PWM
-//	dra = 0.5*(vraref)+0.5; //scale by Vdc then shrink+shift for [-1 1] modulation to [0 1]
-//	drb = 0.5*(vrbref)+0.5; //scale by Vdc then shrink+shift for [-1 1] modulation to [0 1]
-//	drc = 0.5*(vrcref)+0.5; //scale by Vdc then shrink+shift for [-1 1] modulation to [0 1]
+	RackControl(); //ControlB2B() or ControlNPC(), picked once by SelectRack()
 
-	dra = vraref;
-	drb = vrbref;
-	drc = vrcref;
+	//golden-vector capture of this tick's ADC results, enables and compares, also on a degraded tick
+	CaptureSample(IsrEnable); //EN_x are the CAP_F_AFE/INV/NPC bits
 
-	//dra, drb, drc are [0,1] duty cycles
-	SetPWM_Na1((dra)*PWM_PD); //vertical shift by -1 to enable PWM clamping
-	SetPWM_Na2((dra+1.0)*PWM_PD);
+	//debugging, trace recorder (see TraceCfg) to view in CodeComposer debugger graphs and
+	//analog monitor outputs (see MonRoute), skipped on a degraded tick
+	if(!(IsrSkip & DEGRADE_DEBUG))
+	{
+		TraceSample();
+		ServiceMonitor();
+		SnapshotCtrl();
+	}
+	ProfMark(PROF_DEBUG);
 
-	SetPWM_Nb1((drb)*PWM_PD);
-	SetPWM_Nb2((drb+1.0)*PWM_PD);
+	// Acknowledge this interrupt to receive more interrupts from its PIE group
+	AckControlISR();
 
-	SetPWM_Nc1((drc)*PWM_PD);
-	SetPWM_Nc2((drc+1.0)*PWM_PD);
+	ProfEnd();
+	LoadEnd(); //load of this tick, overrun if the next interrupt is already pending
 
-/////////////////////////////////////////END OF NPC CODE///////////////////////////////////////////
-#endif
+	ClearDO_10(); //clear output, square wave should be at 5k for 10kHz ISR (toggling is at 10k)
+	return;
+}
 
 
 
-	//debugging, storage buffers to view in CodeComposer debugger graphs
 
-	vabuff[buffidx] = va; //GetAIN_A0()-2048;
-	vbbuff[buffidx] = vb; //GetAIN_A1()-2048;
-	vcbuff[buffidx] = vc; //GetAIN_A6()-2048;
-	vdcbuff[buffidx] = Vdc;
-	iabuff[buffidx] = ia;
-	ibbuff[buffidx] = ib;
-	icbuff[buffidx] = ic;
+/////////////////////////////////////////CAN///////////////////////////////////////////
+//eCAN receive handlers, run from ecan0_isr() as soon as a message is in (see ECI_CanRx.h).
+//A disable reaches the PWM enable GPIO without waiting for the main loop.
+/////////////////////////////////////////CAN///////////////////////////////////////////
 
-	buffidx++;
-	if(buffidx > 167) buffidx = 0;
+//RxAFEenable(): AFE PWM enable from CANbus.
+void RxAFEenable(volatile struct MBOX *mb)
+{
+	AFEenable = mb->MDL.byte.BYTE0;
+	if(AFEenable == 1)
+		{EnablePWM_R();}
+	else
+		{DisablePWM_R();}
+}
 
-	// Acknowledge this interrupt to receive more interrupts from group 3
-	PieCtrlRegs.PIEACK.all = PIEACK_GROUP3;
+//RxINVenable(): INV PWM enable from CANbus.
+void RxINVenable(volatile struct MBOX *mb)
+{
+	INVenable = mb->MDL.byte.BYTE0;
+	if(INVenable == 1)
+		{EnablePWM_I();}
+	else
+		{DisablePWM_I();}
+}
 
-	ClearDO_10(); //clear output, square wave should be at 5k for 10kHz ISR (toggling is at 10k)
-	return;
+//RxNPCenable(): NPC PWM enable from CANbus, both gate driver enables.
+void RxNPCenable(volatile struct MBOX *mb)
+{
+	NPCenable = mb->MDL.byte.BYTE0;
+	if(NPCenable == 1)
+		{EnablePWM_R();
+		 EnablePWM_I();}
+	else
+		{DisablePWM_R();
+		 DisablePWM_I();}
 }
 
+//RxMonitor(): Analog monitor route from CANbus.
+void RxMonitor(volatile struct MBOX *mb)
+{
+	PARAM_VAL gain;
 
+	gain.u = mb->MDH.all;
+	SetMonitor(mb->MDL.byte.BYTE0 >> 5, mb->MDL.byte.BYTE0 & 0x1F, gain.f,
+		0.01f*(int16)((mb->MDL.byte.BYTE2 << 8) | mb->MDL.byte.BYTE3), mb->MDL.byte.BYTE1);
+}
 
+/////////////////////////////////////////RACK///////////////////////////////////////////
+//Rack profiles, by rack number.
+/////////////////////////////////////////RACK///////////////////////////////////////////
+
+const RACK_PROFILE RackProfile[RACK_PROFILES] =
+{
+	//npc	control		enable		inv			mon			param
+	{0,		ControlB2B,	0x10000000,	0x10000001,	0x10000010,	0x10000020},	//RK1B2B
+	{0,		ControlB2B,	0x10000002,	0x10000003,	0x10000011,	0x10000022},	//RK2B2B
+	{1,		ControlNPC,	0x10000004,	0,			0x10000012,	0x10000024},	//RK1NPC
+	{1,		ControlNPC,	0x10000005,	0,			0x10000013,	0x10000026},	//RK2NPC
+};
+
+//SelectRack(): Picks the rack profile, from RackIdOtp or else the GetDI_9()/GetDI_10() jumpers.  DI inputs
+//	are pulled up, so with no jumpers the rack is RK1B2B, and a jumper to ground sets a bit.
+//	Call before InitCtrl().  The GPIO inputs are readable from reset.
+void SelectRack()
+{
+	RackId = RackIdOtp;
+	if(RackId >= RACK_PROFILES) RackId = (~GetDI_Vec() >> RACK_DI_SHIFT) & (RACK_PROFILES - 1);
+	Rack = &RackProfile[RackId];
+	RackControl = Rack->control;
+}
 
 /////////////////////////////////////////ISR///////////////////////////////////////////
 //Timer interrupt.  The frequency is linked to the PWM 1 interrupt
 /////////////////////////////////////////ISR///////////////////////////////////////////
 
-void main(void)
+//InitBoard(): Picks the rack, clears the controller and sets up the DSP and the CAN mailboxes.
+//	Everything main() does before the loop, also run by the host harness (host/eci_host.c).
+void InitBoard(void)
 {
-
-	float32 V[4] = {0, 0, 0, 0};
+	SelectRack();
+	InitCtrl();								//before DSP_init() enables the control interrupt
 	DSP_init();
 //	EnablePWM_I();
 //	EnablePWM_R();
-	struct ECAN_REGS ECanaShadow;
     InitECanGpio();
     InitECan();
 
-    //Setup mailbox 1 for AFE PWM enable Message ID = 0x10000000
-    //read byte 0 for 1 or 0
-#ifdef RK1B2B
-    ECanaMboxes.MBOX1.MSGID.all = 0x10000000; // message Identifier
-	ECanaMboxes.MBOX1.MSGID.bit.IDE = 1; //extended identifier
-	//set mailbox as receive
-	ECanaShadow.CANMD.all = ECanaRegs.CANMD.all;
-	ECanaShadow.CANMD.bit.MD1 = 1;  //mailbox direction to receive
-	ECanaRegs.CANMD.all = ECanaShadow.CANMD.all;
-	//enable mailbox
-	ECanaShadow.CANME.all = ECanaRegs.CANME.all;
-	ECanaShadow.CANME.bit.ME1 = 1;
-	ECanaRegs.CANME.all = ECanaShadow.CANME.all;
-
-    //Setup mailbox 2 for INV PWM enable Message ID = 0x10000001
-    //read byte 0 for 1 or 0
-	ECanaMboxes.MBOX2.MSGID.all = 0x10000001; // message Identifier
-	ECanaMboxes.MBOX2.MSGID.bit.IDE = 1; //extended identifier
-	//set mailbox as receive
-	ECanaShadow.CANMD.all = ECanaRegs.CANMD.all;
-	ECanaShadow.CANMD.bit.MD2 = 1;  //mailbox direction to receive
-	ECanaRegs.CANMD.all = ECanaShadow.CANMD.all;
-	//enable mailbox
-	ECanaShadow.CANME.all = ECanaRegs.CANME.all;
-	ECanaShadow.CANME.bit.ME2 = 1;
-	ECanaRegs.CANME.all = ECanaShadow.CANME.all;
-#endif
-
-	//change message IDs for rack 2 b2b PWM enables
-#ifdef RK2B2B
-    ECanaMboxes.MBOX1.MSGID.all = 0x10000002; // message Identifier
-	ECanaMboxes.MBOX1.MSGID.bit.IDE = 1; //extended identifier
-	//set mailbox as receive
-	ECanaShadow.CANMD.all = ECanaRegs.CANMD.all;
-	ECanaShadow.CANMD.bit.MD1 = 1;  //mailbox direction to receive
-	ECanaRegs.CANMD.all = ECanaShadow.CANMD.all;
-	//enable mailbox
-	ECanaShadow.CANME.all = ECanaRegs.CANME.all;
-	ECanaShadow.CANME.bit.ME1 = 1;
-	ECanaRegs.CANME.all = ECanaShadow.CANME.all;
-
-    //Setup mailbox 2 for INV PWM enable Message ID = 0x10000003
-    //read byte 0 for 1 or 0
-	ECanaMboxes.MBOX2.MSGID.all = 0x10000003; // message Identifier
-	ECanaMboxes.MBOX2.MSGID.bit.IDE = 1; //extended identifier
-	//set mailbox as receive
-	ECanaShadow.CANMD.all = ECanaRegs.CANMD.all;
-	ECanaShadow.CANMD.bit.MD2 = 1;  //mailbox direction to receive
-	ECanaRegs.CANMD.all = ECanaShadow.CANMD.all;
-	//enable mailbox
-	ECanaShadow.CANME.all = ECanaRegs.CANME.all;
-	ECanaShadow.CANME.bit.ME2 = 1;
-	ECanaRegs.CANME.all = ECanaShadow.CANME.all;
-#endif
-
-#ifdef RK1NPC
-    //Setup mailbox 1 for NPC PWM enable Message ID = 0x10000004
-    //read byte 0 for 1 or 0
-    ECanaMboxes.MBOX1.MSGID.all = 0x10000004; // message Identifier
-	ECanaMboxes.MBOX1.MSGID.bit.IDE = 1; //extended identifier
-	//set mailbox as receive
-	ECanaShadow.CANMD.all = ECanaRegs.CANMD.all;
-	ECanaShadow.CANMD.bit.MD1 = 1;  //mailbox direction to receive
-	ECanaRegs.CANMD.all = ECanaShadow.CANMD.all;
-	//enable mailbox
-	ECanaShadow.CANME.all = ECanaRegs.CANME.all;
-	ECanaShadow.CANME.bit.ME1 = 1;
-	ECanaRegs.CANME.all = ECanaShadow.CANME.all;
-#endif
+	if(Rack->npc)
+		InitCanRxMbox(ENABLE_MBOX, Rack->enable_can_id, RxNPCenable);
+	else
+	{
+		InitCanRxMbox(ENABLE_MBOX, Rack->enable_can_id, RxAFEenable);
+		InitCanRxMbox(INV_MBOX, Rack->inv_can_id, RxINVenable);
+	}
+	InitCanRxMbox(MON_MBOX, Rack->mon_can_id, RxMonitor);
+	InitParamCan(PARAM_MBOX, Rack->param_can_id, PARAM_TX_MBOX, Rack->param_can_id + 1);
+	InitCanRx();
+}
 
-#ifdef RK2NPC
-    //Setup mailbox 1 for NPC PWM enable Message ID = 0x10000005
-    //read byte 0 for 1 or 0
-    ECanaMboxes.MBOX1.MSGID.all = 0x10000005; // message Identifier
-	ECanaMboxes.MBOX1.MSGID.bit.IDE = 1; //extended identifier
-	//set mailbox as receive
-	ECanaShadow.CANMD.all = ECanaRegs.CANMD.all;
-	ECanaShadow.CANMD.bit.MD1 = 1;  //mailbox direction to receive
-	ECanaRegs.CANMD.all = ECanaShadow.CANMD.all;
-	//enable mailbox
-	ECanaShadow.CANME.all = ECanaRegs.CANME.all;
-	ECanaShadow.CANME.bit.ME1 = 1;
-	ECanaRegs.CANME.all = ECanaShadow.CANME.all;
-#endif
+void main(void)
+{
 
+	InitBoard();
 	StartTimer();
 	while(1)
 	{
-
-#if defined(RK1B2B) || defined(RK2B2B)
-		////////////////////////////////////////////
-		//AFE enable signal from CANbus
-		////////////////////////////////////////////
-		if(ECanaRegs.CANRMP.bit.RMP1 == 1)  //valid new data in MBX1?
-		{
-			AFEenable = ECanaMboxes.MBOX1.MDL.byte.BYTE0; //read message
-			ECanaShadow.CANRMP.bit.RMP1 = 1;  //clear status flag RMP1
-			ECanaRegs.CANME.all = ECanaShadow.CANME.all;
-		}
-
-		if(AFEenable == 1)
-			{EnablePWM_R();}
-		else
-			{DisablePWM_R();}
-
-		////////////////////////////////////////////
-		//INV enable signal from CANbus
-		////////////////////////////////////////////
-		if(ECanaRegs.CANRMP.bit.RMP2 == 1)  //valid new data in MBX2?
-		{
-			INVenable = ECanaMboxes.MBOX2.MDL.byte.BYTE0; //read message
-			ECanaShadow.CANRMP.bit.RMP2 = 1;  //clear status flag RMP1
-			ECanaRegs.CANME.all = ECanaShadow.CANME.all;
-		}
-
-		if(INVenable == 1)
-			{EnablePWM_I();}
-		else
-			{DisablePWM_I();}
-
-		//DAC outputs for b2b converters
-
-		V[0] = 0;
-		V[1] = GetAIN_A0()*0.00073242 ; //(3/4096)/0.051703046561388 ; //VaINV
-		V[2] = GetAIN_A1()*0.00073242 ; //(3/4096)/0.011693505697301 ; //VbINV
-		V[3] = GetAIN_A6()*0.00073242 ; //(3/4096)/0.124087311747332 ; //VcINV
-
-		SetAll_AO(V);
-
-		V[0] = 3;
-		V[1] = GetAIN_A2()*0.00073242 ; //(3/4096)/0.051703046561388 ; //IoINVa  0.0931
-		V[2] = GetAIN_A3()*0.00073242 ; //(3/4096)/0.008617174426898 ; //IoINVb  0.006153
-		V[3] = GetAIN_A4()*0.00073242 ; //(3/4096)/0.006152662540805 ; //IoINVc  0.006153
-
-		SetAll_AO(V);
-#endif
-
-
-#if defined(RK1NPC) || defined(RK2NPC)
-		////////////////////////////////////////////
-		//NPC enable signal from CANbus
-		////////////////////////////////////////////
-		if(ECanaRegs.CANRMP.bit.RMP1 == 1)  //valid new data in MBX1?
-		{
-			NPCenable = ECanaMboxes.MBOX1.MDL.byte.BYTE0; //read message
-			ECanaShadow.CANRMP.bit.RMP1 = 1;  //clear status flag RMP1
-			ECanaRegs.CANME.all = ECanaShadow.CANME.all;
-		}
-
-		if(NPCenable == 1)
-			{EnablePWM_R();
-			 EnablePWM_I();}
-		else
-			{DisablePWM_R();
-			 DisablePWM_I();}
-
-		//DAC outputs for NPC
-		V[0] = 0;
-		V[1] = GetAIN_A0()*0.00073242 ; //(3/4096)/0.051703046561388 ; //Vdc1
-		V[2] = GetAIN_A1()*0.00073242 ; //(3/4096)/0.011693505697301 ; //Vdc2
-		V[3] = GetAIN_A2()*0.00073242 ; //(3/4096)/0.124087311747332 ; //Idc+
-
-		SetAll_AO(V);
-
-		V[0] = 3;
-		V[1] = GetAIN_B2()*0.00073242 ; //(3/4096)/0.051703046561388 ; //Ia
-		V[2] = GetAIN_B3()*0.00073242 ; //(3/4096)/0.008617174426898 ; //Ib
-		V[3] = GetAIN_B4()*0.00073242 ; //(3/4096)/0.006152662540805 ; //Ic
-
-		SetAll_AO(V);
-#endif
-
+		if(TraceArmReq) TraceArm(); //trace reconfigured from the debugger
+		if(CapArmReq) CaptureArm(RackId); //capture restarted from the debugger
 	}
 }						
 